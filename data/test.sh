@@ -3,4 +3,7 @@ CJsonTest us-states.json -match 'features/[]/geometry/coordinates'
 
 CJsonTest us-states.json -match 'features/[]/{properties/name,geometry/coordinates}'
 
+CJsonTest us-states.json -lazy -match 'features/[]/properties/name'
+CJsonTest flare.json -lazy -match 'name...children...size'
+
 CJsonTest us-states.json -match 'features/[]/{properties/name,geometry/coordinates}' -flat | sed 's/" \(.*\)/" "\1"/' > us-states.data
@@ -3,14 +3,25 @@
 
 #include <cstdio>
 #include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <atomic>
 #include <iostream>
 #include <vector>
 #include <memory>
 #include <map>
+#include <functional>
+#include <memory_resource>
+#include <shared_mutex>
+#include <unordered_set>
 
 #include <optional>
+#include <string_view>
+#include <type_traits>
 
-class CStrParse;
+class CJsonFileData;
+
+namespace CJsonNumber { struct Decimal; }
 
 //------
 
@@ -50,30 +61,218 @@ class CJson {
   // Json Value base class
   class Value;
 
-  using ValueP = std::shared_ptr<Value>;
+  // memory for values and their child storage
+  using Arena = std::pmr::memory_resource;
 
-  class Value {
+  // allocation counts of document arenas
+  struct AllocStats {
+    size_t count { 0 }; // number of allocations
+    size_t bytes { 0 }; // allocated bytes
+  };
+
+  // Buffered text output for to_string and print.
+  //
+  // Text is appended to one growable buffer which is either returned as a
+  // string or written to a stream or file descriptor in large blocks (so
+  // values are not formatted through a stream token by token).
+  class Writer {
    public:
-    Value(CJson *json, ValueType type) : json_(json), type_(type) { }
+    // output to string (see str)
+    Writer() { }
+
+    // output to stream
+    explicit Writer(std::ostream &os) : os_(&os) { }
+
+    // output to file descriptor
+    explicit Writer(int fd) : fd_(fd) { }
+
+   ~Writer() { flush(); }
+
+    Writer(const Writer &) = delete;
+    Writer &operator=(const Writer &) = delete;
+
+    // string output
+    const std::string &str() const { return buffer_; }
+
+    std::string takeStr() { return std::move(buffer_); }
+
+    //---
+
+    void put(char c) {
+      buffer_ += c;
+
+      checkFlush();
+    }
+
+    void write(std::string_view str) {
+      buffer_.append(str.data(), str.size());
+
+      checkFlush();
+    }
+
+    void writeInteger (int64_t  i);
+    void writeUnsigned(uint64_t u);
+
+    // write real as shortest round trip text (exact integers are written as
+    // integers)
+    void writeReal(double r);
+
+    //---
+
+    // write buffered text to stream or file descriptor (false on error)
+    bool flush();
+
+   private:
+    void checkFlush() {
+      if (buffer_.size() >= s_blockSize && (os_ || fd_ >= 0))
+        (void) flush();
+    }
+
+   private:
+    static constexpr size_t s_blockSize = 64*1024;
+
+    std::string   buffer_;
+    std::ostream* os_ { nullptr };
+    int           fd_ { -1 };
+  };
+
+ private:
+  // loaded input data (kept for lazy values and zero copy strings)
+  using DataP = std::shared_ptr<const CJsonFileData>;
+
+ public:
+
+  // Non-owning value handle.
+  //
+  // Loaded and query result values are owned by their CJson (allocated in its
+  // arenas) and are valid until its next load (which releases them) or until
+  // it is destroyed so handles are plain pointers (no reference counting when
+  // values are passed around or copied).
+  class ValueP {
+   public:
+    ValueP() { }
+
+    ValueP(std::nullptr_t) { }
+
+    explicit ValueP(Value *value) : value_(value) { }
+
+    Value *get() const { return value_; }
+
+    Value *operator->() const { assert(value_); return value_; }
+    Value &operator*() const { assert(value_); return *value_; }
+
+    explicit operator bool() const { return value_; }
+
+    friend bool operator==(const ValueP &lhs, const ValueP &rhs) {
+      return lhs.value_ == rhs.value_;
+    }
+
+    friend bool operator!=(const ValueP &lhs, const ValueP &rhs) {
+      return lhs.value_ != rhs.value_;
+    }
+
+   private:
+    Value *value_ { nullptr };
+  };
+
+  // Interned object member names (symbol table).
+  //
+  // Each distinct name is stored once and its interned view is the name's
+  // symbol: interned names are equal only if their data pointers are equal.
+  // A table can be shared by documents with the same keys (see setSymbols).
+  // Thread safe.
+  class Symbols {
+   public:
+    using Symbol = std::string_view;
+
+    Symbols() { }
+
+    Symbols(const Symbols &) = delete;
+    Symbols &operator=(const Symbols &) = delete;
+
+    // return symbol for name (added if new)
+    Symbol intern(std::string_view name);
+
+    // get symbol for name (false if name has not been interned)
+    bool find(std::string_view name, Symbol &symbol) const;
+
+    // number of distinct names
+    size_t size() const;
+
+   private:
+    using Names = std::unordered_set<std::string_view>;
 
-    virtual ~Value() { }
+    mutable std::shared_mutex           mutex_;
+    std::pmr::monotonic_buffer_resource chars_;
+    Names                               names_;
+  };
+
+  using Symbol   = Symbols::Symbol;
+  using SymbolsP = std::shared_ptr<Symbols>;
+
+  //---
+
+  // Value node
+  //
+  // Values are compact non-virtual nodes: the type tag is stored with the
+  // parent link and operations dispatch on the tag (see the concrete classes
+  // for the per type implementations).
+  //
+  // Values store their parent and their index in the parent (member or
+  // element position) unless built with CJSON_NO_PARENT. Without parents
+  // values are 8 bytes smaller, parent() is always null, parentIndex() is
+  // always 0 and only the document is linked (so code which navigates up
+  // the tree, e.g. the Qt model, cannot be built with this option).
+  class Value {
+   public:
+    Value(CJson *json, ValueType type) :
+     link_(linkBits(json) | (uint64_t(type) << TYPE_SHIFT)) {
+    }
 
     //---
 
-    Value *parent() const { return parent_; }
-    void setParent(Value *p) { parent_ = p; }
+#ifndef CJSON_NO_PARENT
+    Value *parent() const {
+      return (link_ & PARENT_FLAG ? reinterpret_cast<Value *>(link_ & PTR_MASK) : nullptr);
+    }
+
+    // index in parent object or array
+    uint parentIndex() const { return index_; }
+
+    // set parent and index in parent (document is found from parent when
+    // parent is set)
+    void setParent(Value *p, uint index=0) {
+      uint64_t bits = (p ? linkBits(p) | PARENT_FLAG : linkBits(json()));
+
+      link_ = (link_ & ~(PTR_MASK | PARENT_FLAG)) | bits;
+
+      index_ = uint32_t(index);
+    }
+#else
+    Value *parent() const { return nullptr; }
+
+    uint parentIndex() const { return 0; }
+
+    void setParent(Value *, uint=0) { }
+#endif
+
+    // name of value in parent (member name, element index or empty if no parent)
+    std::string parentName() const;
+
+    // owning document (linked or stored in parent object or array)
+    CJson *json() const;
 
     //---
 
-    ValueType type() const { return type_; }
+    ValueType type() const { return ValueType((link_ >> TYPE_SHIFT) & TYPE_MASK); }
 
-    bool isString() const { return type_ == ValueType::VALUE_STRING; }
-    bool isNumber() const { return type_ == ValueType::VALUE_NUMBER; }
-    bool isTrue  () const { return type_ == ValueType::VALUE_TRUE  ; }
-    bool isFalse () const { return type_ == ValueType::VALUE_FALSE ; }
-    bool isNull  () const { return type_ == ValueType::VALUE_NULL  ; }
-    bool isObject() const { return type_ == ValueType::VALUE_OBJECT; }
-    bool isArray () const { return type_ == ValueType::VALUE_ARRAY ; }
+    bool isString() const { return type() == ValueType::VALUE_STRING; }
+    bool isNumber() const { return type() == ValueType::VALUE_NUMBER; }
+    bool isTrue  () const { return type() == ValueType::VALUE_TRUE  ; }
+    bool isFalse () const { return type() == ValueType::VALUE_FALSE ; }
+    bool isNull  () const { return type() == ValueType::VALUE_NULL  ; }
+    bool isObject() const { return type() == ValueType::VALUE_OBJECT; }
+    bool isArray () const { return type() == ValueType::VALUE_ARRAY ; }
 
     bool isComposite() const { return isObject() || isArray(); }
 
@@ -98,45 +297,56 @@ class CJson {
     std::string toString() const {
       assert(isString());
       auto *str = cast<CJson::String>();
-      return str->value();
+      return std::string(str->value());
     }
 
     //---
 
-    virtual uint numValues() const { return 1; }
+    uint numValues() const;
 
-    virtual std::string indexKey(uint i) { assert(i == 0); return ""; }
+    std::string indexKey(uint i);
 
-    virtual ValueP indexValue(uint i) { assert(i == 0); return ValueP(); }
+    ValueP indexValue(uint i);
 
     //---
 
+    // is value of type T (String, Number, ...)
+    template<typename T>
+    bool isType() const { return type() == T::TYPE; }
+
     template<typename T>
     T *cast() {
-      T *t = dynamic_cast<T *>(this);
-      assert(t);
+      assert(isType<T>());
 
-      return t;
+      return static_cast<T *>(this);
     }
 
     template<typename T>
     const T *cast() const {
-      const T *t = dynamic_cast<const T *>(this);
-      assert(t);
+      assert(isType<T>());
 
-      return t;
+      return static_cast<const T *>(this);
+    }
+
+    // cast to type T (nullptr if not of type T)
+    template<typename T>
+    T *tryCast() {
+      return (isType<T>() ? static_cast<T *>(this) : nullptr);
     }
 
     //---
 
-    virtual const char *typeName() const { return "value"; }
+    const char *typeName() const;
 
-    virtual std::string hierTypeName() const { return typeName(); }
+    std::string hierTypeName() const;
 
     //---
 
-    virtual std::string to_string() const = 0;
-    virtual std::string to_name  () const { return to_string(); }
+    std::string to_string() const;
+    std::string to_name  () const;
+
+    // write text of to_string
+    void write(Writer &writer) const;
 
     std::string hier_name() const;
 
@@ -146,12 +356,17 @@ class CJson {
 
     //---
 
-    virtual void print(std::ostream &os=std::cout) const = 0;
+    void print     (Writer &writer) const;
+    void printReal (Writer &writer) const;
+    void printShort(Writer &writer) const;
+    void printName (Writer &writer) const;
+    void printValue(Writer &writer) const;
 
-    virtual void printReal (std::ostream &os=std::cout) const { print(os); }
-    virtual void printShort(std::ostream &os=std::cout) const { print(os); }
-    virtual void printName (std::ostream &os=std::cout) const { print(os); }
-    virtual void printValue(std::ostream &os=std::cout) const { print(os); }
+    void print     (std::ostream &os=std::cout) const { Writer writer(os); print     (writer); }
+    void printReal (std::ostream &os=std::cout) const { Writer writer(os); printReal (writer); }
+    void printShort(std::ostream &os=std::cout) const { Writer writer(os); printShort(writer); }
+    void printName (std::ostream &os=std::cout) const { Writer writer(os); printName (writer); }
+    void printValue(std::ostream &os=std::cout) const { Writer writer(os); printValue(writer); }
 
     friend std::ostream &operator<<(std::ostream &os, const Value &v) {
       v.print(os);
@@ -159,47 +374,151 @@ class CJson {
       return os;
     }
 
+    //---
+
+    // destroy value of any type (values have no virtual destructor)
+    static void destroy(Value *value);
+
+   protected:
+    bool isLinkFlag(uint64_t flag) const { return link_ & flag; }
+
+    void setLinkFlag(uint64_t flag) { link_ |= flag; }
+
+    uint64_t linkField(uint64_t shift, uint64_t mask) const { return (link_ >> shift) & mask; }
+
+    void setLinkField(uint64_t shift, uint64_t mask, uint64_t value) {
+      link_ = (link_ & ~(mask << shift)) | ((value & mask) << shift);
+    }
+
    protected:
-    CJson*    json_   { nullptr };
-    Value*    parent_ { nullptr };
-    ValueType type_   { ValueType::VALUE_NONE };
+    // link_ layout: pointer in low 56 bits (parent if PARENT_FLAG else document),
+    // type in bits 56-59, flags in bits 60-61 and type specific bits 62-63
+    // (number kind or string inline flag)
+    enum : uint64_t {
+      PTR_MASK     = (uint64_t(1) << 56) - 1,
+      TYPE_SHIFT   = 56,
+      TYPE_MASK    = 0xf,
+      PARENT_FLAG  = uint64_t(1) << 60,
+      OWNED_FLAG   = uint64_t(1) << 61,
+      NUMBER_SHIFT = 62,
+      NUMBER_MASK  = 0x3,
+      INLINE_FLAG  = uint64_t(1) << 62
+    };
+
+   private:
+    static uint64_t linkBits(const void *p) {
+      auto bits = uint64_t(reinterpret_cast<uintptr_t>(p));
+      assert(! (bits & ~PTR_MASK));
+      return bits;
+    }
+
+   private:
+    uint64_t link_ { 0 };
+#ifndef CJSON_NO_PARENT
+    uint32_t index_ { 0 };
+#endif
   };
 
-  using Values = std::vector<ValueP>;
+  using Values = std::pmr::vector<ValueP>;
 
   //---
 
   // Json String
   class String : public Value {
    public:
-    String(CJson *json, const std::string &str) :
-     Value(json, ValueType::VALUE_STRING), str_(str) {
+    static constexpr ValueType TYPE = ValueType::VALUE_STRING;
+
+    // string is copied unless isView (string must then outlive value, e.g. document
+    // data). Short strings are copied into the value, longer strings are allocated
+    // in arena (if specified) else on the heap.
+    String(CJson *json, std::string_view str, bool isView=false, Arena *arena=nullptr) :
+     Value(json, TYPE) {
+      size_t len = str.size();
+
+      if      (isView) {
+        data_.ref.str = str.data();
+        data_.ref.len = len;
+      }
+      else if (len <= MAX_INLINE) {
+        memcpy(data_.chars, str.data(), len);
+
+        data_.chars[MAX_INLINE] = char(len);
+
+        setLinkFlag(INLINE_FLAG);
+      }
+      else {
+        char *chars;
+
+        if (arena)
+          chars = static_cast<char *>(arena->allocate(len, 1));
+        else {
+          chars = new char [len];
+
+          setLinkFlag(OWNED_FLAG);
+        }
+
+        memcpy(chars, str.data(), len);
+
+        data_.ref.str = chars;
+        data_.ref.len = len;
+      }
+    }
+
+   ~String() {
+      if (isLinkFlag(OWNED_FLAG))
+        delete [] data_.ref.str;
     }
 
+    String(const String &) = delete;
+    String &operator=(const String &) = delete;
+
     //---
 
-    const std::string &value() const { return str_; }
+    std::string_view value() const {
+      if (isLinkFlag(INLINE_FLAG))
+        return std::string_view(data_.chars, size_t(uint8_t(data_.chars[MAX_INLINE])));
+
+      return std::string_view(data_.ref.str, data_.ref.len);
+    }
 
     bool toReal(double &r) const;
 
     //---
 
-    const char *typeName() const override { return "string"; }
+    const char *typeName() const { return "string"; }
 
     //---
 
-    std::string to_string() const override { return str_; }
+    std::string to_string() const { return std::string(value()); }
 
-    //---
+    void write(Writer &writer) const { writer.write(value()); }
 
-    void print(std::ostream &os=std::cout) const override;
+    //---
 
-    void printReal(std::ostream &os=std::cout) const override;
+    void print     (Writer &writer) const;
+    void printReal (Writer &writer) const;
+    void printShort(Writer &writer) const { writer.write(value()); }
 
-    void printShort(std::ostream &os=std::cout) const override;
+    void print     (std::ostream &os=std::cout) const { Writer writer(os); print     (writer); }
+    void printReal (std::ostream &os=std::cout) const { Writer writer(os); printReal (writer); }
+    void printShort(std::ostream &os=std::cout) const { Writer writer(os); printShort(writer); }
 
    private:
-    std::string str_;
+    // chars (or reference to chars) with inline length in last byte
+    union Data {
+      struct Ref {
+        const char* str;
+        size_t      len;
+      };
+
+      Ref  ref;
+      char chars[sizeof(Ref)];
+    };
+
+    // max length of inline string
+    static constexpr size_t MAX_INLINE = sizeof(Data) - 1;
+
+    Data data_ { { nullptr, 0 } };
   };
 
   //---
@@ -207,28 +526,114 @@ class CJson {
   // Json Number
   class Number : public Value {
    public:
+    static constexpr ValueType TYPE = ValueType::VALUE_NUMBER;
+
     Number(CJson *json, double value=0.0) :
-     Value(json, ValueType::VALUE_NUMBER), value_(value) {
+     Value(json, TYPE), real_(value) {
     }
 
+    // exact integer (of any integral type except bool)
+    template<typename T, typename = std::enable_if_t<std::is_integral<T>::value &&
+                                                     ! std::is_same<T, bool>::value>>
+    Number(CJson *json, T i) :
+     Value(json, TYPE) {
+      if (std::is_signed<T>::value || uint64_t(i) <= uint64_t(INT64_MAX)) {
+        integer_ = int64_t(i);
+
+        setKind(Kind::INTEGER);
+      }
+      else {
+        unsigned_ = uint64_t(i);
+
+        setKind(Kind::UNSIGNED);
+      }
+    }
+
+    // bool is not a number (use True/False)
+    Number(CJson *json, bool b) = delete;
+
+    // number from (valid) number text which is kept (it must outlive the value,
+    // e.g. document data) and only converted when the value is needed
+    Number(CJson *json, std::string_view text);
+
     //---
 
-    double value() const { return value_; }
+    double value() const {
+      switch (kind()) {
+        case Kind::INTEGER : return double(integer_);
+        case Kind::UNSIGNED: return double(unsigned_);
+        case Kind::TEXT    : return textValue();
+        default            : return real_;
+      }
+    }
+
+    // is number stored as an (int64 or uint64) integer or integer text
+    bool isInteger() const;
+
+    // is value held exactly by a double
+    bool isExactReal() const;
+
+    // get value as integer (false if not an integer or out of range).
+    // Integral reals are converted.
+    bool toInt64 (int64_t  &i) const;
+    bool toUInt64(uint64_t &u) const;
+
+    // compare values (-1, 0, 1), integers are compared exactly
+    int cmp(const Number &rhs) const;
+
+    // number text (if created from text)
+    bool hasText() const { return kind() == Kind::TEXT; }
+
+    std::string_view text() const {
+      assert(hasText());
+      return std::string_view(reinterpret_cast<const char *>(text_ & TEXT_PTR_MASK),
+                              size_t(text_ >> TEXT_LEN_SHIFT));
+    }
 
     //---
 
-    const char *typeName() const override { return "number"; }
+    const char *typeName() const { return "number"; }
 
     //---
 
-    std::string to_string() const override { return std::to_string(value_); }
+    std::string to_string() const;
+
+    // text is same as print
+    void write(Writer &writer) const { print(writer); }
 
     //---
 
-    void print(std::ostream &os=std::cout) const override;
+    void print(Writer &writer) const;
+
+    void print(std::ostream &os=std::cout) const { Writer writer(os); print(writer); }
+
+   private:
+    enum class Kind {
+      REAL,
+      INTEGER,
+      UNSIGNED,
+      TEXT
+    };
+
+    Kind kind() const { return Kind(linkField(NUMBER_SHIFT, NUMBER_MASK)); }
+
+    void setKind(Kind kind) { setLinkField(NUMBER_SHIFT, NUMBER_MASK, uint64_t(kind)); }
+
+    double textValue() const;
 
    private:
-    double value_ { 0.0 };
+    // text_ layout: pointer in low 48 bits and length in high 16 bits
+    enum : uint64_t {
+      TEXT_LEN_SHIFT = 48,
+      TEXT_PTR_MASK  = (uint64_t(1) << TEXT_LEN_SHIFT) - 1
+    };
+
+    union {
+      double   real_ { 0.0 };
+      int64_t  integer_;
+      uint64_t unsigned_;
+      uint64_t text_;
+    };
   };
 
   //---
@@ -236,8 +641,10 @@ class CJson {
   // Json True
   class True : public Value {
    public:
+    static constexpr ValueType TYPE = ValueType::VALUE_TRUE;
+
     True(CJson *json) :
-     Value(json, ValueType::VALUE_TRUE) {
+     Value(json, TYPE) {
     }
 
     //---
@@ -246,15 +653,19 @@ class CJson {
 
     //---
 
-    const char *typeName() const override { return "true"; }
+    const char *typeName() const { return "true"; }
 
     //---
 
-    std::string to_string() const override { return "true"; }
+    std::string to_string() const { return "true"; }
+
+    void write(Writer &writer) const { writer.write("true"); }
 
     //---
 
-    void print(std::ostream &os=std::cout) const override;
+    void print(Writer &writer) const;
+
+    void print(std::ostream &os=std::cout) const { Writer writer(os); print(writer); }
   };
 
   //---
@@ -262,8 +673,10 @@ class CJson {
   // Json False
   class False : public Value {
    public:
+    static constexpr ValueType TYPE = ValueType::VALUE_FALSE;
+
     False(CJson *json) :
-     Value(json, ValueType::VALUE_FALSE) {
+     Value(json, TYPE) {
     }
 
     //---
@@ -272,15 +685,19 @@ class CJson {
 
     //---
 
-    const char *typeName() const override { return "false"; }
+    const char *typeName() const { return "false"; }
 
     //---
 
-    std::string to_string() const override { return "false"; }
+    std::string to_string() const { return "false"; }
+
+    void write(Writer &writer) const { writer.write("false"); }
 
     //---
 
-    void print(std::ostream &os=std::cout) const override;
+    void print(Writer &writer) const;
+
+    void print(std::ostream &os=std::cout) const { Writer writer(os); print(writer); }
   };
 
   //---
@@ -288,8 +705,10 @@ class CJson {
   // Json Null
   class Null : public Value {
    public:
+    static constexpr ValueType TYPE = ValueType::VALUE_NULL;
+
     Null(CJson *json) :
-     Value(json, ValueType::VALUE_NULL) {
+     Value(json, TYPE) {
     }
 
     //---
@@ -298,43 +717,143 @@ class CJson {
 
     //---
 
-    const char *typeName() const override { return "null"; }
+    const char *typeName() const { return "null"; }
 
     //---
 
-    std::string to_string() const override { return "null"; }
+    std::string to_string() const { return "null"; }
+
+    void write(Writer &writer) const { writer.write("null"); }
 
     //---
 
-    void print(std::ostream &os=std::cout) const override;
+    void print(Writer &writer) const;
+
+    void print(std::ostream &os=std::cout) const { Writer writer(os); print(writer); }
+  };
+
+  //---
+
+  // Object shape (hidden class): the member names of an object in order.
+  //
+  // Loaded objects with the same names in the same order share one immutable
+  // shape so each object only stores its values. An object which is changed
+  // after it is loaded gets its own (unshared) copy of its shape.
+  class Shape {
+   public:
+    Shape(const Symbol *keys, size_t n, bool shared, Arena *arena);
+
+    Shape(const Shape &) = delete;
+    Shape &operator=(const Shape &) = delete;
+
+    bool isShared() const { return shared_; }
+
+    size_t size() const { return keys_.size(); }
+
+    Symbol key(size_t i) const { return keys_[i]; }
+
+    const Symbol *keys() const { return keys_.data(); }
+
+    // check if keys match
+    bool isKeys(const Symbol *keys, size_t n) const;
+
+    // index of last key with symbol (-1 if none)
+    int find(Symbol symbol) const;
+
+    // index of last key with name (-1 if none). Small shapes compare names,
+    // larger ones look up the name's symbol in symbols.
+    int findName(std::string_view name, const Symbols &symbols) const;
+
+    // add key (unshared shape only)
+    void addKey(Symbol symbol);
+
+   private:
+    // build hash index of all keys
+    void buildIndex();
+
+    // add key to hash index
+    void addIndex(size_t i);
+
+   private:
+    using Keys = std::pmr::vector<Symbol>;
+
+    // open addressing hash table of key index + 1 (0 is empty slot). Built
+    // when shape is created or grows so lookups never change it.
+    using Index = std::pmr::vector<uint32_t>;
+
+    Keys  keys_;
+    Index index_;
+    bool  shared_ { false };
   };
 
   //---
 
-  // Json Object (name/value map)
+  // Json Object (name/value members in document order)
+  //
+  // Names are symbols interned in the document's symbol table so names are
+  // compared by pointer. Names are stored in the object's shape (usually
+  // shared) and values in the object. Small objects are searched linearly,
+  // larger ones use a hash index of the shape.
   class Object : public Value {
    public:
-    using NameValueMap   = std::map<std::string, ValueP>;
-    using NameValue      = std::pair<std::string, ValueP>;
-    using NameValueArray = std::vector<NameValue>;
-    using Names          = std::vector<std::string>;
+    static constexpr ValueType TYPE = ValueType::VALUE_OBJECT;
+
+    using NameValue = std::pair<std::string_view, ValueP>;
+    using Names     = std::vector<std::string>;
+
+    // view of object members as name/value pairs
+    class NameValueArray {
+     public:
+      class iterator {
+       public:
+        iterator(const Object *obj, size_t i) : obj_(obj), i_(i) { }
+
+        NameValue operator*() const { return obj_->nameValue(i_); }
+
+        iterator &operator++() { ++i_; return *this; }
+
+        bool operator==(const iterator &rhs) const { return i_ == rhs.i_; }
+        bool operator!=(const iterator &rhs) const { return i_ != rhs.i_; }
+
+       private:
+        const Object *obj_ { nullptr };
+        size_t        i_   { 0 };
+      };
+
+      NameValueArray(const Object *obj) : obj_(obj) { }
+
+      size_t size() const { return obj_->values_.size(); }
+
+      bool empty() const { return obj_->values_.empty(); }
+
+      NameValue operator[](size_t i) const { return obj_->nameValue(i); }
+
+      iterator begin() const { return iterator(obj_, 0); }
+      iterator end  () const { return iterator(obj_, size()); }
+
+     private:
+      const Object *obj_ { nullptr };
+    };
 
    public:
-    Object(CJson *json) :
-     Value(json, ValueType::VALUE_OBJECT) {
+    Object(CJson *json, Arena *arena=std::pmr::get_default_resource()) :
+     Value(json, TYPE), json_(json), values_(arena) {
     }
 
-   ~Object() { }
+   ~Object();
 
-    //---
+    Object(const Object &) = delete;
+    Object &operator=(const Object &) = delete;
 
-    const NameValueMap &nameValueMap() const { return nameValueMap_; }
+    //---
 
-    const NameValueArray &nameValueArray() const { return nameValueArray_; }
+    NameValueArray nameValueArray() const { expand(); return NameValueArray(this); }
 
     void getNames(Names &names) const {
-      for (const auto &nv : nameValueArray_)
-        names.push_back(nv.first);
+      expand();
+
+      for (size_t i = 0; i < values_.size(); ++i)
+        names.push_back(std::string(shape_->key(i)));
     }
 
     Names getNames() const {
@@ -344,104 +863,136 @@ class CJson {
     }
 
     void getValues(Values &values) const {
-      for (const auto &nv : nameValueArray_)
-        values.push_back(nv.second);
+      expand();
+
+      for (const auto &value : values_)
+        values.push_back(value);
     }
 
-    bool hasName(const std::string &name) const {
-      auto p = nameValueMap_.find(name);
+    bool hasName(std::string_view name) const {
+      expand();
 
-      return (p != nameValueMap_.end());
+      return (findName(name) >= 0);
     }
 
-    void setNamedValue(const std::string &name, const ValueP &value) {
-      auto p = nameValueMap_.find(name);
+    // set named value. A repeated name adds a new member which replaces the
+    // previous value for lookup.
+    void setNamedValue(std::string_view name, const ValueP &value) {
+      setSymbolValue(json_->symbols()->intern(name), value);
+    }
 
-      if (p == nameValueMap_.end())
-        p = nameValueMap_.insert(p, NameValueMap::value_type(name, value));
-      else
-        (*p).second = value;
+    // set named value for name interned in document's symbol table
+    void setSymbolValue(Symbol symbol, const ValueP &value);
 
-      nameValueArray_.emplace_back(name, value);
-    }
+    // set all members of (empty) object from shape and values (loader)
+    void setShapeValues(Shape *shape, const ValueP *values, size_t n);
+
+    bool getNamedValue(std::string_view name, ValueP &value) const {
+      expand();
 
-    bool getNamedValue(const std::string &name, ValueP &value) const {
-      auto p = nameValueMap_.find(name);
+      int i = findName(name);
 
-      if (p == nameValueMap_.end())
+      if (i < 0)
         return false;
 
-      value = (*p).second;
+      value = values_[size_t(i)];
 
       return true;
     }
 
-    ValueP getNamedValue(const std::string &name) const {
+    ValueP getNamedValue(std::string_view name) const {
       ValueP value;
       assert(getNamedValue(name, value));
       return value;
     }
 
+    // get value for name symbol (see CJson::findSymbol). Names are compared by
+    // pointer so look up the symbol once to find a name in many objects.
+    bool getSymbolValue(Symbol symbol, ValueP &value) const {
+      expand();
+
+      int i = (shape_ ? shape_->find(symbol) : -1);
+
+      if (i < 0)
+        return false;
+
+      value = values_[size_t(i)];
+
+      return true;
+    }
+
+    bool hasSymbol(Symbol symbol) const {
+      expand();
+
+      return (shape_ && shape_->find(symbol) >= 0);
+    }
+
     template<typename T>
-    bool getNamedValueT(const std::string &name, T *&t) const {
+    bool getNamedValueT(std::string_view name, T *&t) const {
       ValueP value;
 
       if (! getNamedValue(name, value))
         return false;
 
-      t = dynamic_cast<T *>(value.get());
+      t = value->tryCast<T>();
 
-      if (! t)
-        return false;
-
-      return true;
+      return (t != nullptr);
     }
 
     template<typename T>
-    T *getNamedValueT(const std::string &name) const {
+    T *getNamedValueT(std::string_view name) const {
       T *t { nullptr };
       assert(getNamedValueT(name, t));
       return t;
     }
 
     bool indexNameValue(uint i, std::string &name, ValueP &value) const {
-      if (i >= nameValueArray_.size())
-        return false;
+      expand();
 
-      const NameValue &nameValue = nameValueArray_[i];
+      if (i >= values_.size())
+        return false;
 
-      name  = nameValue.first;
-      value = nameValue.second;
+      name  = std::string(shape_->key(i));
+      value = values_[i];
 
       return true;
     }
 
+    // shape of object (nullptr if no members)
+    const Shape *shape() const { expand(); return shape_; }
+
     //---
 
-    const char *typeName() const override { return "object"; }
+    const char *typeName() const { return "object"; }
 
-    std::string hierTypeName() const override;
+    std::string hierTypeName() const;
 
     //---
 
-    uint numValues() const override { return uint(nameValueArray_.size()); }
+    uint numValues() const { expand(); return uint(values_.size()); }
+
+    std::string indexKey(uint i) {
+      expand();
 
-    std::string indexKey(uint i) override {
       assert(i < numValues());
 
-      return nameValueArray_[i].first;
+      return std::string(shape_->key(i));
     }
 
-    ValueP indexValue(uint i) override {
+    ValueP indexValue(uint i) {
+      expand();
+
       assert(i < numValues());
 
-      return nameValueArray_[i].second;
+      return values_[i];
     }
 
     //---
 
-    std::string to_string() const override;
-    std::string to_name  () const override;
+    std::string to_string() const;
+    std::string to_name  () const;
+
+    void write(Writer &writer) const;
 
     //---
 
@@ -451,80 +1002,613 @@ class CJson {
 
     //---
 
-    void print(std::ostream &os=std::cout) const override;
+    void print     (Writer &writer) const;
+    void printReal (Writer &writer) const;
+    void printName (Writer &writer) const;
+    void printValue(Writer &writer) const;
+
+    void print     (std::ostream &os=std::cout) const { Writer writer(os); print     (writer); }
+    void printReal (std::ostream &os=std::cout) const { Writer writer(os); printReal (writer); }
+    void printName (std::ostream &os=std::cout) const { Writer writer(os); printName (writer); }
+    void printValue(std::ostream &os=std::cout) const { Writer writer(os); printValue(writer); }
+
+    //---
+
+    // contents are parsed from lazy input range (in kept data) on first access
+    void setLazy(const char *begin, const char *end) { lazyBegin_ = begin; lazyEnd_ = end; }
 
-    void printReal(std::ostream &os=std::cout) const override;
+    bool isLazy() const { return lazyBegin_; }
 
-    void printName(std::ostream &os=std::cout) const override;
+   private:
+    void expand() const {
+      if (lazyBegin_)
+        json()->expandValue(const_cast<Object *>(this), values_.get_allocator().resource(),
+                            lazyBegin_, lazyEnd_);
+    }
+
+    NameValue nameValue(size_t i) const { return NameValue(shape_->key(i), values_[i]); }
 
-    void printValue(std::ostream &os=std::cout) const override;
+    // index of last member with name (-1 if none)
+    int findName(std::string_view name) const;
 
    private:
-    NameValueMap   nameValueMap_;
-    NameValueArray nameValueArray_;
+    friend class Value;
+
+    CJson*              json_      { nullptr }; // document (for child values)
+    Shape*              shape_     { nullptr };
+    Values              values_;
+    mutable const char* lazyBegin_ { nullptr };
+    mutable const char* lazyEnd_   { nullptr };
   };
 
   //---
 
   // Json Array
+  //
+  // Arrays of numbers (read by the loader) store their numbers contiguously.
+  // Number values for them are only created when the values are accessed
+  // (see numbers() for direct access).
   class Array : public Value {
    public:
-    Array(CJson *json) :
-     Value(json, ValueType::VALUE_ARRAY) {
+    static constexpr ValueType TYPE = ValueType::VALUE_ARRAY;
+
+    // view of array values
+    class ValueArray {
+     public:
+      ValueArray(const ValueP *values, size_t size) : values_(values), size_(size) { }
+
+      size_t size() const { return size_; }
+
+      bool empty() const { return size_ == 0; }
+
+      const ValueP &operator[](size_t i) const { return values_[i]; }
+
+      const ValueP *begin() const { return values_; }
+      const ValueP *end  () const { return values_ + size_; }
+
+     private:
+      const ValueP *values_ { nullptr };
+      size_t        size_   { 0 };
+    };
+
+    // view of numbers of numeric array (like std::span<const double>)
+    class NumberSpan {
+     public:
+      NumberSpan() { }
+
+      NumberSpan(const double *data, size_t size) : data_(data), size_(size) { }
+
+      const double *data() const { return data_; }
+
+      size_t size() const { return size_; }
+
+      bool empty() const { return size_ == 0; }
+
+      double operator[](size_t i) const { return data_[i]; }
+
+      const double *begin() const { return data_; }
+      const double *end  () const { return data_ + size_; }
+
+     private:
+      const double *data_ { nullptr };
+      size_t        size_ { 0 };
+    };
+
+   public:
+    Array(CJson *json, Arena *arena=std::pmr::get_default_resource()) :
+     Value(json, TYPE), json_(json), arena_(arena) {
     }
 
-   ~Array() { }
+   ~Array();
+
+    Array(const Array &) = delete;
+    Array &operator=(const Array &) = delete;
 
     //---
 
-    const Values &values() const { return values_; }
+    // values (creates number values of numeric array)
+    ValueArray values() const {
+      expand();
+
+      auto *values = values_.load(std::memory_order_acquire);
+
+      if (! values && numbers_)
+        values = makeNumberValues();
 
-    void addValue(const ValueP &value) {
-      values_.push_back(value);
+      return ValueArray(values, size_);
     }
 
-    uint size() const { return uint(values_.size()); }
+    void addValue(const ValueP &value);
 
-    ValueP at(uint i) const { return values_[i]; }
+    uint size() const { expand(); return size_; }
+
+    ValueP at(uint i) const { return values()[i]; }
 
     template<typename T>
     T *atT(uint i) const {
-      T *t = dynamic_cast<T *>(values_[i].get());
+      auto *value = at(i).get();
 
-      return t;
+      return (value ? value->tryCast<T>() : nullptr);
     }
 
     //---
 
-    const char *typeName() const override { return "array"; }
+    // is array of numbers stored contiguously
+    bool isNumeric() const { expand(); return numbers_; }
+
+    // numbers of numeric array (empty if not numeric)
+    NumberSpan numbers() const { expand(); return NumberSpan(numbers_, numbers_ ? size_ : 0); }
 
-    std::string hierTypeName() const override;
+    // set all values of (empty) array (loader)
+    void setValues(const ValueP *values, size_t n);
+
+    // set all numbers of (empty) array (loader)
+    void setNumbers(const double *numbers, size_t n);
 
     //---
 
-    uint numValues() const override { return size(); }
+    const char *typeName() const { return "array"; }
+
+    std::string hierTypeName() const;
+
+    //---
 
-    std::string indexKey(uint) override { return ""; }
+    uint numValues() const { return size(); }
 
-    ValueP indexValue(uint i) override {
+    std::string indexKey(uint) { return ""; }
+
+    ValueP indexValue(uint i) {
       assert(i < numValues());
 
-      return values_[i];
+      return at(i);
     }
 
     //---
 
-    std::string to_string() const override;
-    std::string to_name  () const override;
+    std::string to_string() const;
+    std::string to_name  () const;
+
+    void write(Writer &writer) const;
+
+    //---
+
+    void print    (Writer &writer) const;
+    void printReal(Writer &writer) const;
+
+    void print    (std::ostream &os=std::cout) const { Writer writer(os); print    (writer); }
+    void printReal(std::ostream &os=std::cout) const { Writer writer(os); printReal(writer); }
 
     //---
 
-    void print(std::ostream &os=std::cout) const override;
+    // contents are parsed from lazy input range (in kept data) on first access
+    void setLazy(const char *begin, const char *end) { lazyBegin_ = begin; lazyEnd_ = end; }
 
-    void printReal(std::ostream &os=std::cout) const override;
+    bool isLazy() const { return lazyBegin_; }
 
    private:
-    Values values_;
+    void expand() const {
+      if (lazyBegin_)
+        json()->expandValue(const_cast<Array *>(this), arena_, lazyBegin_, lazyEnd_);
+    }
+
+    // create number values for numbers (thread safe)
+    ValueP *makeNumberValues() const;
+
+   private:
+    friend class Value;
+
+    using ValuesPtr = std::atomic<ValueP *>;
+
+    CJson*              json_      { nullptr }; // document (for child values)
+    Arena*              arena_     { nullptr };
+    mutable ValuesPtr   values_    { nullptr }; // values (created on demand if numeric)
+    double*             numbers_   { nullptr }; // numbers (if numeric)
+    uint32_t            size_      { 0 };
+    uint32_t            capacity_  { 0 };       // allocated size of values_
+    mutable const char* lazyBegin_ { nullptr };
+    mutable const char* lazyEnd_   { nullptr };
+  };
+
+  //------
+
+  // Json parse event handler
+  //  . called in document order as values are read (no values are created)
+  //  . strings are only valid for the duration of the call
+  //  . integers (digits with no fraction or exponent) are sent to integer
+  //    (int64 range) or unsignedInteger (larger uint64), by default these
+  //    call number
+  //  . return false to stop the parse (parse returns false)
+  class Handler {
+   public:
+    Handler() { }
+
+    virtual ~Handler() { }
+
+    virtual bool startObject() { return true; }
+    virtual bool key(std::string_view /*name*/) { return true; }
+    virtual bool endObject() { return true; }
+
+    virtual bool startArray() { return true; }
+    virtual bool endArray() { return true; }
+
+    virtual bool string(std::string_view /*str*/) { return true; }
+    virtual bool number(double /*r*/) { return true; }
+    virtual bool integer(int64_t i) { return number(double(i)); }
+    virtual bool unsignedInteger(uint64_t u) { return number(double(u)); }
+    virtual bool boolean(bool /*b*/) { return true; }
+    virtual bool null() { return true; }
+  };
+
+  //------
+
+  // Incremental parser for input which arrives in chunks (pipes, sockets).
+  //
+  // Parse state is kept between chunks (including inside strings, escapes and
+  // numbers) and events are sent (or values added to the tree) as soon as
+  // they are complete.
+  class PushParser {
+   public:
+    // build value tree (see root()). This is a load so values of the
+    // previous load are released.
+    PushParser(CJson *json);
+
+    // send events to handler
+    PushParser(CJson *json, Handler &handler);
+
+   ~PushParser();
+
+    PushParser(const PushParser &) = delete;
+    PushParser &operator=(const PushParser &) = delete;
+
+    // parse next chunk (returns false on error or if handler stopped parse)
+    bool feed(const char *data, size_t len);
+
+    // end of input (returns false on error or incomplete document)
+    bool finish();
+
+    // root value (built so far) when building value tree
+    ValueP root() const;
+
+    bool isError() const { return state_ == State::ERROR; }
+
+    bool isDone() const { return state_ == State::DONE; }
+
+   private:
+    enum class State {
+      VALUE,          // value (root or after object colon)
+      OBJECT_START,   // after '{' : key or '}'
+      OBJECT_KEY,     // after ',' in object : key
+      OBJECT_COLON,   // after key : ':'
+      OBJECT_NEXT,    // after object value : ',' or '}'
+      ARRAY_START,    // after '[' : value or ']'
+      ARRAY_VALUE,    // after ',' in array : value
+      ARRAY_NEXT,     // after array value : ',' or ']'
+      STRING,         // in string
+      STRING_ESCAPE,  // after backslash in string
+      STRING_UNICODE, // in \u hex digits
+      NUMBER,         // in number
+      LITERAL,        // in true, false or null
+      END,            // after root value
+      DONE,           // finished
+      ERROR           // error or stopped by handler
+    };
+
+    enum class NumberState {
+      START,        // before '-' or first digit
+      SIGN,         // after '-'
+      ZERO,         // after leading '0'
+      INTEGER,      // in integer digits
+      POINT,        // after '.'
+      FRACTION,     // in fraction digits
+      EXPONENT,     // after 'e'
+      EXPONENT_SIGN,// after exponent sign
+      EXPONENT_DIGITS
+    };
+
+    using Stack = std::vector<char>;
+
+    struct NumberData;
+
+    const char *feedChars(const char *p, const char *e);
+
+    const char *startValue(const char *p, const char *e);
+    const char *startString(const char *p, const char *e, bool isKey);
+
+    const char *readString (const char *p, const char *e);
+    const char *readEscape (const char *p, const char *e);
+    const char *readUnicode(const char *p, const char *e);
+    const char *readNumber (const char *p, const char *e);
+    const char *readLiteral(const char *p, const char *e);
+
+    bool endString(std::string_view str);
+    bool endNumber();
+    bool endValue(bool rc);
+
+    bool startObject();
+    bool endObject();
+    bool startArray();
+    bool endArray();
+
+    const char *error(size_t pos, const char *msg);
+    bool stop();
+
+    size_t charPos(const char *p) const { return size_t(p - chunk_) + chunkPos_; }
+
+   private:
+    CJson*                      json_          { nullptr };
+    std::unique_ptr<Handler>    builder_;
+    Handler*                    handler_       { nullptr };
+    State                       state_         { State::VALUE };
+    Stack                       stack_;
+    bool                        space_         { false };
+    const char*                 chunk_         { nullptr };
+    size_t                      chunkPos_      { 0 };
+    char                        quote_         { '\"' };
+    bool                        isKey_         { false };
+    std::string                 buffer_;
+    int                         unicodeLen_    { 0 };
+    long                        unicodeValue_  { 0 };
+    std::unique_ptr<NumberData> number_;
+    const char*                 literal_       { nullptr };
+    int                         literalLen_    { 0 };
+    size_t                      literalPos_    { 0 };
+  };
+
+  //------
+
+ private:
+  class TapeBuilder;
+
+ public:
+  // Flat (tape) representation of a document.
+  //
+  // Values are stored in document order as 64 bit entries (tag in the top
+  // 8 bits, payload below) with string chars in a separate buffer:
+  //  . object/array : start entry has the index after its end entry (low 32
+  //                   bits) and the number of values (next 24 bits, saturated),
+  //                   end entry has the index of its start entry
+  //  . key/string   : offset of the (32 bit length prefixed) chars
+  //  . number       : next entry is the double, int64 or uint64 bits
+  //  . true/false/null have no payload
+  //
+  // Loading a tape needs no per value allocation and the tape is plain data
+  // (independent of its CJson) so it can be copied or saved as is. Values are
+  // read with cursors (like Object/Array access) or converted to value trees
+  // (see loadTapeFile, tapeValue).
+  class Tape {
+   public:
+    using Entries = std::vector<uint64_t>;
+
+    // position of value in tape
+    class Cursor {
+     public:
+      using NameValue = std::pair<std::string_view, Cursor>;
+
+      // view of object members as name/value pairs
+      class NameValueArray {
+       public:
+        class iterator {
+         public:
+          iterator(const Tape *tape, size_t ind) : tape_(tape), ind_(ind) { }
+
+          NameValue operator*() const {
+            return NameValue(Cursor(tape_, ind_).str(), Cursor(tape_, ind_ + 1));
+          }
+
+          iterator &operator++() { ind_ = Cursor(tape_, ind_ + 1).next().index(); return *this; }
+
+          bool operator==(const iterator &rhs) const { return ind_ == rhs.ind_; }
+          bool operator!=(const iterator &rhs) const { return ind_ != rhs.ind_; }
+
+         private:
+          const Tape *tape_ { nullptr };
+          size_t      ind_  { 0 };
+        };
+
+        // members of object at ind (empty if not an object)
+        NameValueArray(const Tape *tape, size_t ind) : tape_(tape), ind_(ind) {
+          if (Cursor(tape_, ind_).isObject()) {
+            begin_ = ind_ + 1;
+            end_   = Cursor(tape_, ind_).next().index() - 1;
+          }
+        }
+
+        size_t size() const { return Cursor(tape_, ind_).size(); }
+
+        bool empty() const { return begin_ == end_; }
+
+        iterator begin() const { return iterator(tape_, begin_); }
+        iterator end  () const { return iterator(tape_, end_  ); }
+
+       private:
+        const Tape *tape_  { nullptr };
+        size_t      ind_   { 0 };
+        size_t      begin_ { 0 };
+        size_t      end_   { 0 };
+      };
+
+      // view of array values
+      class ValueArray {
+       public:
+        class iterator {
+         public:
+          iterator(const Tape *tape, size_t ind) : tape_(tape), ind_(ind) { }
+
+          Cursor operator*() const { return Cursor(tape_, ind_); }
+
+          iterator &operator++() { ind_ = Cursor(tape_, ind_).next().index(); return *this; }
+
+          bool operator==(const iterator &rhs) const { return ind_ == rhs.ind_; }
+          bool operator!=(const iterator &rhs) const { return ind_ != rhs.ind_; }
+
+         private:
+          const Tape *tape_ { nullptr };
+          size_t      ind_  { 0 };
+        };
+
+        // values of array at ind (empty if not an array)
+        ValueArray(const Tape *tape, size_t ind) : tape_(tape), ind_(ind) {
+          if (Cursor(tape_, ind_).isArray()) {
+            begin_ = ind_ + 1;
+            end_   = Cursor(tape_, ind_).next().index() - 1;
+          }
+        }
+
+        size_t size() const { return Cursor(tape_, ind_).size(); }
+
+        bool empty() const { return begin_ == end_; }
+
+        iterator begin() const { return iterator(tape_, begin_); }
+        iterator end  () const { return iterator(tape_, end_  ); }
+
+       private:
+        const Tape *tape_  { nullptr };
+        size_t      ind_   { 0 };
+        size_t      begin_ { 0 };
+        size_t      end_   { 0 };
+      };
+
+     public:
+      Cursor() { }
+
+      Cursor(const Tape *tape, size_t ind) : tape_(tape), ind_(ind) { }
+
+      const Tape *tape() const { return tape_; }
+
+      // index of value's (first) entry in tape
+      size_t index() const { return ind_; }
+
+      bool isValid() const { return tape_ && ind_ < tape_->entries_.size(); }
+
+      //---
+
+      ValueType type() const;
+
+      const char *typeName() const { return CJson::typeName(type()); }
+
+      bool isString() const { return type() == ValueType::VALUE_STRING; }
+      bool isNumber() const { return type() == ValueType::VALUE_NUMBER; }
+      bool isTrue  () const { return type() == ValueType::VALUE_TRUE  ; }
+      bool isFalse () const { return type() == ValueType::VALUE_FALSE ; }
+      bool isBool  () const { return isTrue() || isFalse(); }
+      bool isNull  () const { return type() == ValueType::VALUE_NULL  ; }
+      bool isObject() const { return type() == ValueType::VALUE_OBJECT; }
+      bool isArray () const { return type() == ValueType::VALUE_ARRAY ; }
+
+      bool isComposite() const { return isObject() || isArray(); }
+
+      //---
+
+      // chars of string (or object member name)
+      std::string_view str() const;
+
+      // value of number (integers converted to double)
+      double number() const;
+
+      // is number stored as integer
+      bool isInteger() const;
+
+      // get number as exact int64 (false if not integral or out of range)
+      bool toInt64(int64_t &i) const;
+
+      //---
+
+      // number of object members or array values
+      uint size() const;
+
+      // object members (empty if not an object)
+      NameValueArray nameValueArray() const { return NameValueArray(tape_, ind_); }
+
+      bool hasName(std::string_view name) const {
+        Cursor value;
+
+        return getNamedValue(name, value);
+      }
+
+      // get named value of object (last value for repeated name)
+      bool getNamedValue(std::string_view name, Cursor &value) const;
+
+      // array values (empty if not an array)
+      ValueArray values() const { return ValueArray(tape_, ind_); }
+
+      // array value (invalid cursor if out of range). Scans values so use
+      // values() to visit many values
+      Cursor at(uint i) const;
+
+      //---
+
+      // value after this one (skips contents of object or array)
+      Cursor next() const;
+
+      // send value's parse events to handler (returns false if handler stops)
+      bool parse(Handler &handler) const;
+
+     private:
+      uint64_t entry(size_t i) const { return tape_->entries_[i]; }
+
+     private:
+      const Tape *tape_ { nullptr };
+      size_t      ind_  { 0 };
+    };
+
+   public:
+    Tape() { }
+
+    // root value (invalid if empty)
+    Cursor root() const { return Cursor(this, 0); }
+
+    bool empty() const { return entries_.empty(); }
+
+    void clear() { entries_.clear(); strings_.clear(); }
+
+    //---
+
+    // raw tape data (for saving and restoring tapes)
+    const Entries &entries() const { return entries_; }
+    const std::string &strings() const { return strings_; }
+
+    void setData(const Entries &entries, const std::string &strings) {
+      entries_ = entries;
+      strings_ = strings;
+    }
+
+   private:
+    friend class CJson::TapeBuilder;
+
+    enum Tag : uint8_t {
+      TAG_OBJECT_START = '{',
+      TAG_OBJECT_END   = '}',
+      TAG_ARRAY_START  = '[',
+      TAG_ARRAY_END    = ']',
+      TAG_KEY          = ':',
+      TAG_STRING       = '"',
+      TAG_REAL         = 'd',
+      TAG_INTEGER      = 'l',
+      TAG_UNSIGNED     = 'u',
+      TAG_TRUE         = 't',
+      TAG_FALSE        = 'f',
+      TAG_NULL         = 'n'
+    };
+
+    static constexpr int      TAG_SHIFT    = 56;
+    static constexpr uint64_t PAYLOAD_MASK = (uint64_t(1) << TAG_SHIFT) - 1;
+
+    // container start payload (end index and saturated count)
+    static constexpr int      COUNT_SHIFT = 32;
+    static constexpr uint64_t INDEX_MASK  = 0xFFFFFFFF;
+    static constexpr uint64_t COUNT_MASK  = 0xFFFFFF;
+
+    static Tag tag(uint64_t entry) { return Tag(entry >> TAG_SHIFT); }
+
+    static uint64_t payload(uint64_t entry) { return entry & PAYLOAD_MASK; }
+
+    static uint64_t makeEntry(Tag tag, uint64_t payload) {
+      return (uint64_t(tag) << TAG_SHIFT) | payload;
+    }
+
+   private:
+    Entries     entries_;
+    std::string strings_;
   };
 
   //------
@@ -580,6 +1664,84 @@ class CJson {
 
   //---
 
+  // number of threads for parallel loads (0 is number of cpus)
+  void setNumThreads(int n) { numThreads_ = n; }
+  int numThreads() const { return numThreads_; }
+
+  //---
+
+  // maximum nesting depth of objects and arrays (0 for no limit). Deeper
+  // input fails to parse. Lazy values are limited from their own depth when
+  // they are parsed.
+  void setMaxDepth(int n) { maxDepth_ = n; }
+  int maxDepth() const { return maxDepth_; }
+
+  // maximum size in bytes of a document or lines record (0 for no limit)
+  void setMaxSize(size_t n) { maxSize_ = n; }
+  size_t maxSize() const { return maxSize_; }
+
+  //---
+
+  // parse large arrays (top level or in top level object) in parallel
+  // (see setNumThreads)
+  void setParallelLoad(bool b) { parallelLoad_ = b; }
+  bool isParallelLoad() const { return parallelLoad_; }
+
+  //---
+
+  // load objects and arrays lazily. Their contents are only parsed on first
+  // access (the input data is kept until the next load) so errors
+  // inside them are not reported by the load. Access to lazy values is not
+  // thread safe.
+  void setLazyLoad(bool b) { lazyLoad_ = b; }
+  bool isLazyLoad() const { return lazyLoad_; }
+
+  //---
+
+  // string values without escapes reference the input data instead of
+  // copying it. The data of the load is then kept until the next load.
+  void setZeroCopy(bool b) { zeroCopy_ = b; }
+  bool isZeroCopy() const { return zeroCopy_; }
+
+  //---
+
+  // numbers keep their text in the input data and are only converted when
+  // their value is used (printed exactly as read). The data of the load is
+  // then kept until the next load. Arrays of raw numbers are not stored as
+  // contiguous doubles.
+  void setRawNumbers(bool b) { rawNumbers_ = b; }
+  bool isRawNumbers() const { return rawNumbers_; }
+
+
+  //---
+
+  // memory map regular files in loadFile (else read into buffer)
+  void setMapFile(bool b) { mapFile_ = b; }
+  bool isMapFile() const { return mapFile_; }
+
+  //---
+
+  // symbol table for object names. A table can be shared by documents. It
+  // must be set before any names are added to the current table (names of
+  // existing objects are in that table) so setSymbols fails if it has names.
+  const SymbolsP &symbols() const { return symbols_; }
+  bool setSymbols(const SymbolsP &symbols);
+
+  // symbol of object member name for Object::getSymbolValue (empty symbol,
+  // which matches no member, if name is not in symbol table)
+  Symbol findSymbol(std::string_view name) const;
+
+  //---
+
+  // allocations made for loaded and query result values (and their child
+  // storage) in the document arenas. Not valid during a load.
+  AllocStats allocStats() const;
+
+  //---
+
+  // Each load (file, string, data or lines) releases the values of the
+  // previous load and all query results.
+
   // load file and return root value
   bool loadFile(const std::string &filename, ValueP &value);
 
@@ -591,7 +1753,7 @@ class CJson {
     if (! loadFile(filename.c_str(), value1))
       return false;
 
-    value = dynamic_cast<T *>(value1.get());
+    value = value1->tryCast<T>();
 
     if (! value)
       return false;
@@ -602,6 +1764,59 @@ class CJson {
   // load string and return root value
   bool loadString(const std::string &lines, ValueP &value);
 
+  // load character data and return root value
+  bool loadData(const char *data, size_t len, ValueP &value);
+
+  //---
+
+  // JSON Lines/NDJSON (one value per line, blank lines are ignored).
+  // Records are parsed in parallel (see setNumThreads) but always returned
+  // in file order. A bad record stops the load (earlier records are kept).
+
+  // called for each record with its (one based) line number
+  // (return false to stop). For processLines the record value, and query
+  // results created while processing it, are only valid during the call.
+  using LineProc = std::function<bool(size_t line, const ValueP &value)>;
+
+  // load lines file and return record values
+  bool loadLinesFile(const std::string &filename, Values &values);
+
+  // load lines character data and return record values
+  bool loadLinesData(const char *data, size_t len, Values &values);
+
+  // load lines file and call proc for each record
+  bool processLinesFile(const std::string &filename, const LineProc &proc);
+
+  // load lines character data and call proc for each record
+  bool processLinesData(const char *data, size_t len, const LineProc &proc);
+
+  //---
+
+  // parse file and send events to handler
+  bool parseFile(const std::string &filename, Handler &handler);
+
+  // parse string and send events to handler
+  bool parseString(const std::string &lines, Handler &handler);
+
+  // parse character data and send events to handler
+  bool parseData(const char *data, size_t len, Handler &handler);
+
+  //---
+
+  // load file into tape (see Tape). Strings are copied to the tape and
+  // numbers converted so lazy load, zero copy and raw numbers do not apply.
+  bool loadTapeFile(const std::string &filename, Tape &tape);
+
+  // load string into tape
+  bool loadTapeString(const std::string &lines, Tape &tape);
+
+  // load character data into tape
+  bool loadTapeData(const char *data, size_t len, Tape &tape);
+
+  // create value tree for tape value. Values are added to the document
+  // (like lazy values this is not thread safe).
+  ValueP tapeValue(const Tape::Cursor &cursor);
+
   //---
 
   template<typename FUNC>
@@ -609,6 +1824,12 @@ class CJson {
     return processNameNodes(OptString(), value, 0, f);
   }
 
+  // process tape values (f is called with cursors)
+  template<typename FUNC>
+  void processNodes(const Tape::Cursor &value, const FUNC &f) {
+    return processNameNodes(OptString(), value, 0, f);
+  }
+
   template<typename FUNC>
   void processNameNodes(const OptString &name, const ValueP value, int depth, const FUNC &f) {
     if (! f(name, value, depth))
@@ -636,6 +1857,30 @@ class CJson {
     }
   }
 
+  template<typename FUNC>
+  void processNameNodes(const OptString &name, const Tape::Cursor &value, int depth,
+                        const FUNC &f) {
+    if (! f(name, value, depth))
+      return;
+
+    switch (value.type()) {
+      case ValueType::VALUE_OBJECT: {
+        for (const auto &nv : value.nameValueArray())
+          processNameNodes(OptString(nv.first), nv.second, depth + 1, f);
+
+        break;
+      }
+      case ValueType::VALUE_ARRAY: {
+        for (const auto &v : value.values())
+          processNameNodes(OptString(), v, depth + 1, f);
+
+        break;
+      }
+      default:
+        break;
+    }
+  }
+
   //---
 
   template<typename T>
@@ -662,9 +1907,15 @@ class CJson {
 
   bool matchValues(const ValueP &value, int i, const std::string &match, Values &values);
 
+  // match tape values (matched values are created with tapeValue)
+  bool matchValues(const Tape::Cursor &value, const std::string &match, Values &values);
+
   //---
 
  private:
+  class Parse;
+  class DomBuilder;
+
   template<typename Tag, typename T>
   struct TypeMap {
     using Type = CJson::Null;
@@ -687,22 +1938,86 @@ class CJson {
 
   //---
 
-  // read string at file pos
-  bool readString(CStrParse &parse, std::string &str1);
+  // read string at file pos (view of input or decoded into buffer)
+  bool readString(Parse &parse, std::string &buffer, std::string_view &str);
+
+  // read number text at file pos (and accumulate decimal if specified)
+  bool readNumber(Parse &parse, std::string_view &text, CJsonNumber::Decimal *decimal=nullptr);
+
+  // read value at file pos (objects and arrays are read iteratively)
+  template<typename HANDLER>
+  bool readValue(Parse &parse, HANDLER &handler);
+
+  // read string, number or literal value at file pos
+  template<typename HANDLER>
+  bool readScalar(Parse &parse, HANDLER &handler, std::string &buffer);
+
+  // read object member name and separator at file pos
+  template<typename HANDLER>
+  bool readMemberName(Parse &parse, HANDLER &handler, std::string &buffer);
+
+  // read top level value and check for extra characters
+  template<typename HANDLER>
+  bool readRoot(Parse &parse, HANDLER &handler);
+
+  // read large array at file pos using worker threads
+  // (returns false if not handled, array is then read normally)
+  bool readArrayParallel(Parse &parse, DomBuilder &builder);
+
+  // read object or array at file pos as lazy value
+  // (returns false if not handled, value is then read normally)
+  bool readLazy(Parse &parse, DomBuilder &builder);
+
+  // parse contents of lazy object or array into its (load) arena (lazy range
+  // is reset)
+  bool expandValue(Value *value, Arena *arena, const char *&begin, const char *&end);
 
-  // read number at file pos
-  bool readNumber(CStrParse &parse, std::string &str1);
+  // load data kept for values (lazy load or zero copy)
+  bool loadKeptData(const DataP &data, ValueP &value);
 
-  // read object at file pos
-  bool readObject(CStrParse &parse, Object *&obj);
+  // load single value from character data
+  // (keepData is data kept for values, for lazy load or zero copy, and arena
+  // is arena of calling thread, main arena if not specified)
+  bool loadRecord(const char *data, size_t len, ValueP &value, bool quiet,
+                  const DataP &keepData=DataP(), Arena *arena=nullptr);
 
-  // read array at file pos
-  bool readArray(CStrParse &parse, Array *&array);
+  // load lines file and call proc for each record (record values are kept
+  // until the next load if keepValues is set)
+  bool processLinesFile(const std::string &filename, const LineProc &proc, bool keepValues);
 
-  // read value at file pos
-  bool readValue(CStrParse &parse, ValueP &value);
+  // load lines character data and call proc for each record (keepValues as
+  // for processLinesFile)
+  bool processLinesData(const char *data, size_t len, const LineProc &proc, bool keepValues);
 
-  bool readLine(FILE *fp, std::string &line);
+  // load lines character data (keepData as for loadRecord, keepValues as for
+  // processLinesFile)
+  bool processLines(const char *data, size_t len, const LineProc &proc,
+                    const DataP &keepData, bool keepValues);
+
+  // is data of load kept (for lazy load, zero copy and raw numbers)
+  bool isKeepData() const { return isLazyLoad() || isZeroCopy() || isRawNumbers(); }
+
+  // keep data until next load (for lazy load, zero copy and raw numbers)
+  void keepData(const DataP &data);
+
+  // get kept data containing pointer
+  DataP findKeptData(const char *p) const;
+
+  // main (loading thread) arena and new arena for worker thread
+  Arena *mainArena();
+  Arena *newArena();
+
+  // release arena from newArena (and its values) before the document
+  void releaseArena(Arena *arena);
+
+  // release query results (and values created on demand for loaded values)
+  void releaseResults();
+
+  // release all values, and data kept for them, of previous load
+  void releaseValues();
+
+  // number of worker threads to use
+  uint numWorkerThreads() const;
 
   template<typename T, typename FUNC>
   bool processValues(const Object *obj, const std::string &name, const FUNC &f) {
@@ -733,7 +2048,7 @@ class CJson {
       if (! obj->getNamedValueT<Type>(name, v))
         return false;
 
-      f(v->value());
+      f(T(v->value()));
     }
 
     return true;
@@ -741,24 +2056,35 @@ class CJson {
 
   //------
 
-  bool matchObject(const ValueP &value, const std::string &match, ValueP &value1);
+  // match functions for value tree (NODE is ValueP) or tape (NODE is Tape::Cursor).
+  // Created values (keys, sizes, ...) are returned in result.
+  template<typename NODE>
+  bool matchNodeValues(const NODE &value, int ind, const std::string &match, Values &values);
+
+  template<typename NODE>
+  bool matchObject(const NODE &value, const std::string &match, NODE &value1, ValueP &result);
 
-  bool matchArray(const ValueP &value, const std::string &lhs, const std::string &rhs,
+  template<typename NODE>
+  bool matchArray(const NODE &value, const std::string &lhs, const std::string &rhs,
                   Values &values);
-  bool matchList(const ValueP &value, int ind, const std::string &lhs, const std::string &rhs,
+  template<typename NODE>
+  bool matchList(const NODE &value, int ind, const std::string &lhs, const std::string &rhs,
                  Values &values);
 
-  bool matchHier(const ValueP &value, int ind, const std::string &lhs, const std::string &rhs,
+  template<typename NODE>
+  bool matchHier(const NODE &value, int ind, const std::string &lhs, const std::string &rhs,
                  Values &values);
-  bool matchHier1(const ValueP &value, int ind, const std::string &lhs, const std::string &rhs,
-                  const Names &keys, Values &ivalues, Values &values);
+  template<typename NODE, typename KEY>
+  bool matchHier1(const NODE &value, const KEY &lhs, const KEY &rhs,
+                  const std::vector<KEY> &keys, Values &ivalues, Values &values);
 
   String *hierValuesToKey(const Values &values, const Values &kvalues);
 
   //------
 
-  String* createString(const std::string &str);
+  String* createString(std::string_view str, bool isView=false);
   Number* createNumber(double r);
+  Number* createInteger(int64_t i);
   True*   createTrue();
   False*  createFalse();
   Null*   createNull();
@@ -767,11 +2093,12 @@ class CJson {
 
   //------
 
-  bool errorMsg(const CStrParse &parse, const std::string &msg) const;
+  bool errorMsg(const Parse &parse, const std::string &msg) const;
+  bool errorMsg(size_t pos, const std::string &msg) const;
 
-  std::string printSep() const;
-  std::string printPrefix(bool isArray=false) const;
-  std::string printPostfix(bool isArray=false) const;
+  const char *printSep() const;
+  const char *printPrefix(bool isArray=false) const;
+  const char *printPostfix(bool isArray=false) const;
 
  private:
   struct PrintData {
@@ -787,6 +2114,37 @@ class CJson {
   bool      quiet_            { false };
   PrintData printData_        { false };
   bool      stringToReal_     { false };
+  bool      mapFile_          { true };
+  int       numThreads_       { 0 };
+  int       maxDepth_         { 10000 };
+  size_t    maxSize_          { 0 };
+  bool      parallelLoad_     { false };
+  bool      lazyLoad_         { false };
+  bool      zeroCopy_         { false };
+  bool      rawNumbers_       { false };
+
+  class Arenas;
+  class Shapes;
+
+  std::vector<DataP>      keptData_;
+  std::unique_ptr<Arenas> arenas_;
+  SymbolsP                symbols_;
+  std::unique_ptr<Shapes> shapes_;
 };
 
+//------
+
+inline CJson *
+CJson::Value::
+json() const
+{
+  if (! (link_ & PARENT_FLAG))
+    return reinterpret_cast<CJson *>(link_ & PTR_MASK);
+
+  // parent is an object or array which stores its document
+  auto *parent = reinterpret_cast<const Value *>(link_ & PTR_MASK);
+
+  return (parent->isObject() ? parent->cast<Object>()->json_ : parent->cast<Array>()->json_);
+}
+
 #endif
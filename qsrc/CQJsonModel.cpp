@@ -1,6 +1,11 @@
 #include <CQJsonModel.h>
 #include <CJson.h>
 
+// tree navigation (parent, row) uses value parent links and parent indices
+#ifdef CJSON_NO_PARENT
+#error "CQJsonModel needs value parents (CJson built with CJSON_NO_PARENT)"
+#endif
+
 CQJsonModel::
 CQJsonModel()
 {
@@ -124,7 +129,7 @@ isRootHierarchical(QString &hierName, QStringList &hierColumns) const
 
     int i = 0;
 
-    for (const auto &nv : obj->nameValueMap()) {
+    for (const auto &nv : obj->nameValueArray()) {
       if      (nv.second->isArray()) {
         if (array)
           return false;
@@ -136,7 +141,7 @@ isRootHierarchical(QString &hierName, QStringList &hierColumns) const
         return false;
       }
       else {
-        columnMap[i++] = nv.first.c_str();
+        columnMap[i++] = QString::fromUtf8(nv.first.data(), int(nv.first.size()));
       }
     }
 
@@ -187,7 +192,7 @@ isObjHierarchical(const std::string &name, CJson::Object *obj, ColumnMap &column
 
   int i = 0;
 
-  for (const auto &nv : obj->nameValueMap()) {
+  for (const auto &nv : obj->nameValueArray()) {
     if      (nv.second->isArray()) {
       if (array)
         return false;
@@ -201,7 +206,7 @@ isObjHierarchical(const std::string &name, CJson::Object *obj, ColumnMap &column
       return false;
     }
     else {
-      columnMap[i++] = nv.first.c_str();
+      columnMap[i++] = QString::fromUtf8(nv.first.data(), int(nv.first.size()));
     }
   }
 
@@ -226,7 +231,7 @@ isColumnArray(ColumnArrayData &data) const
 
   data.numRows = -1;
 
-  for (const auto &nv : obj->nameValueMap()) {
+  for (const auto &nv : obj->nameValueArray()) {
     if (! nv.second->isArray())
       return false;
 
@@ -266,9 +271,17 @@ isColumnArray(ColumnArrayData &data) const
       QVariant var;
 
       if      (value->isString())
-        var = QString::fromStdString(value->cast<CJson::String>()->value());
-      else if (value->isNumber())
-        var = value->cast<CJson::Number>()->value();
+        var = QString::fromStdString(value->toString());
+      else if (value->isNumber()) {
+        auto *number = value->cast<CJson::Number>();
+
+        int64_t i;
+
+        if (number->isInteger() && number->toInt64(i))
+          var = qlonglong(i);
+        else
+          var = number->value();
+      }
       else if (value->isTrue())
         var = QVariant(true);
       else if (value->isFalse())
@@ -400,7 +413,7 @@ rowCount(const QModelIndex &parent) const
     if      (parentValue->isObject()) {
       auto *obj = parentValue->cast<CJson::Object>();
 
-      return int(obj->nameValueMap().size());
+      return int(obj->nameValueArray().size());
     }
     else if (parentValue->isArray()) {
       return int(parentValue->numValues());
@@ -503,32 +516,7 @@ QString
 CQJsonModel::
 parentName(CJson::Value *value) const
 {
-  auto *parent = value->parent();
-
-  if (! parent)
-    return "";
-
-  if      (parent->isObject()) {
-    auto *obj = parent->cast<CJson::Object>();
-
-    for (size_t i = 0; i < obj->nameValueMap().size(); ++i) {
-      std::string   name1;
-      CJson::ValueP value1;
-
-      if (obj->indexNameValue(uint(i), name1, value1) && value1.get() == value)
-        return name1.c_str();
-    }
-  }
-  else if (parent->isArray()) {
-    auto *array = parent->cast<CJson::Array>();
-
-    for (size_t i = 0; i < array->size(); ++i) {
-      if (array->at(uint(i)).get() == value)
-        return QString("%1").arg(i);
-    }
-  }
-
-  return "";
+  return QString::fromStdString(value->parentName());
 }
 
 QVariant
@@ -663,7 +651,7 @@ index(int row, int column, const QModelIndex &parent) const
     if      (parentValue->isObject()) {
       auto *obj = parentValue->cast<CJson::Object>();
 
-      if (row < 0 || row >= int(obj->nameValueMap().size()))
+      if (row < 0 || row >= int(obj->nameValueArray().size()))
         return QModelIndex();
 
       std::string   name;
@@ -722,14 +710,8 @@ parent(const QModelIndex &index) const
     auto *parentParentObj = parentParentArray->parent()->cast<CJson::Object>();
     assert(parentParentObj);
 
-    // find index of parentObj in parentParentArray
-    for (uint i = 0; i < parentParentArray->size(); ++i) {
-      if (parentParentArray->at(i).get() == parentObj)
-        return createIndex(int(i), 0, parentObj);
-    }
-
-    // always non-leaf parent
-    return createIndex(0, 0, parentObj);
+    // row is index of parentObj in parentParentArray
+    return createIndex(int(parentObj->parentIndex()), 0, parentObj);
   }
   else if (columnArray_) {
     return QModelIndex();
@@ -753,27 +735,8 @@ parent(const QModelIndex &index) const
     if (! parentParentValue)
       return createIndex(0, 0, jsonValue_.get());
 
-    if      (parentParentValue->isObject()) {
-      auto *obj = parentParentValue->cast<CJson::Object>();
-
-      for (size_t i = 0; i < obj->nameValueMap().size(); ++i) {
-        std::string   name;
-        CJson::ValueP value;
-
-        if (obj->indexNameValue(uint(i), name, value) && value.get() == parentValue)
-          return createIndex(int(i), 0, parentValue);
-      }
-    }
-    else if (parentParentValue->isArray()) {
-      auto *array = parentParentValue->cast<CJson::Array>();
-
-      for (size_t i = 0; i < array->size(); ++i) {
-        if (array->at(uint(i)).get() == parentValue)
-          return createIndex(int(i), 0, parentValue);
-      }
-    }
-
-    return QModelIndex();
+    // row is index of parentValue in parentParentValue (object or array)
+    return createIndex(int(parentValue->parentIndex()), 0, parentValue);
   }
 }
 
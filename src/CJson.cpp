@@ -1,7 +1,19 @@
 #include <CJson.h>
-#include <CStrParse.h>
+#include <CJsonArena.h>
+#include <CJsonDomBuilder.h>
+#include <CJsonFileData.h>
+#include <CJsonNumber.h>
+#include <CJsonScan.h>
+#include <CJsonShapes.h>
+#include <CJsonTapeBuilder.h>
 #include <CUtf8.h>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
 #include <set>
+#include <thread>
+#include <type_traits>
+#include <cstring>
 
 namespace {
   inline int hexCharValue(char c) {
@@ -9,12 +21,149 @@ namespace {
 
     return (tolower(c) - 'a' + 10);
   }
+
+  inline bool isDigitChar(char c) {
+    return (static_cast<unsigned char>(c - '0') <= 9);
+  }
+
+  // compare 4 chars as a single word
+  inline bool isWord4(const char *p, const char *e, const char *word) {
+    return (e - p >= 4 && memcmp(p, word, 4) == 0);
+  }
+
+  // minimum size of array to parse in parallel
+  const size_t s_parallelBytes = 1024*1024;
+
+  // number of element ranges per worker thread (for load balancing)
+  const size_t s_parallelChunks = 8;
+
+  // maximum number of object members searched without a hash index
+  const size_t s_objectLinearNames = 16;
+
+  // hash of symbol (interned name address)
+  inline size_t symbolHash(std::string_view symbol) {
+    auto h = uint64_t(reinterpret_cast<uintptr_t>(symbol.data()));
+
+    return size_t((h * 0x9e3779b97f4a7c15ULL) >> 32);
+  }
+
+  // stack of open objects and arrays (one bit each, set for object) for the
+  // iterative parser. Typical depths use the inline words.
+  class ContainerStack {
+   public:
+    ContainerStack() { }
+
+    size_t depth() const { return depth_; }
+
+    bool empty() const { return depth_ == 0; }
+
+    bool isObject() const {
+      size_t i = depth_ - 1;
+
+      return (word(i >> 6) >> (i & 63)) & 1;
+    }
+
+    void push(bool isObject) {
+      size_t i = depth_++;
+
+      if ((i >> 6) >= s_inlineWords && (i >> 6) - s_inlineWords >= words_.size())
+        words_.push_back(0);
+
+      uint64_t &w   = word(i >> 6);
+      uint64_t  bit = uint64_t(1) << (i & 63);
+
+      w = (isObject ? w | bit : w & ~bit);
+    }
+
+    void pop() { --depth_; }
+
+   private:
+    uint64_t &word(size_t i) {
+      return (i < s_inlineWords ? inline_[i] : words_[i - s_inlineWords]);
+    }
+
+    uint64_t word(size_t i) const {
+      return (i < s_inlineWords ? inline_[i] : words_[i - s_inlineWords]);
+    }
+
+   private:
+    static constexpr size_t s_inlineWords = 4;
+
+    size_t                depth_ { 0 };
+    uint64_t              inline_[s_inlineWords];
+    std::vector<uint64_t> words_;
+  };
 }
 
 //------
 
+// pointer cursor over the input data (data is not copied)
+class CJson::Parse {
+ public:
+  Parse(const char *data, size_t len) :
+   begin_(data), p_(data), end_(data + len) {
+  }
+
+  // parse of [p, e) in data starting at begin (for positions)
+  Parse(const char *begin, const char *p, const char *e) :
+   begin_(begin), p_(p), end_(e) {
+  }
+
+  const char *begin() const { return begin_; }
+  const char *ptr() const { return p_; }
+  const char *end() const { return end_; }
+
+  void setPtr(const char *p) { p_ = p; }
+
+  size_t getPos() const { return size_t(p_ - begin_); }
+
+  // suppress error messages
+  bool isQuiet() const { return quiet_; }
+  void setQuiet(bool b) { quiet_ = b; }
+
+  // allow parallel parse of large arrays
+  bool isParallel() const { return parallel_; }
+  void setParallel(bool b) { parallel_ = b; }
+
+  // data kept for values (lazy load or zero copy)
+  const DataP &keepData() const { return keepData_; }
+  void setKeepData(const DataP &data) { keepData_ = data; }
+
+  // objects and arrays at or below depth are lazy values of kept data
+  // (-1 for none)
+  bool isLazy(int depth) const { return (lazyDepth_ >= 0 && depth >= lazyDepth_); }
+  void setLazyDepth(int depth) { lazyDepth_ = depth; }
+
+  // nesting depth of value at start (for depth limit)
+  size_t depth() const { return depth_; }
+  void setDepth(size_t depth) { depth_ = depth; }
+
+  bool eof() const { return (p_ >= end_); }
+
+  bool isChar(char c) const { return (p_ < end_ && *p_ == c); }
+
+  void skipChar() { ++p_; }
+
+  void skipSpace() { p_ = CJsonScan::skipSpace(p_, end_); }
+
+ private:
+  const char* begin_    { nullptr };
+  const char* p_        { nullptr };
+  const char* end_      { nullptr };
+  bool        quiet_    { false };
+  bool        parallel_ { false };
+
+  DataP       keepData_;
+  int         lazyDepth_ { -1 };
+  size_t      depth_     { 0 };
+};
+
+//------
+
 CJson::
-CJson()
+CJson() :
+ arenas_(std::make_unique<Arenas>()), symbols_(std::make_shared<Symbols>()),
+ shapes_(std::make_unique<Shapes>())
 {
 }
 
@@ -57,32 +206,59 @@ stol(const std::string &str, bool &ok)
   return i;
 }
 
-// read string at file pos
+// read string at file pos (view of input or decoded into buffer)
 bool
 CJson::
-readString(CStrParse &parse, std::string &str1)
+readString(Parse &parse, std::string &buffer, std::string_view &str)
 {
+  const char *p = parse.ptr();
+  const char *e = parse.end();
+
   char startChar = '\"';
 
   if (isAllowSingleQuote()) {
-    if (! parse.isChar('\"') && ! parse.isChar('\''))
+    if (p >= e || (*p != '\"' && *p != '\''))
       return errorMsg(parse, "Missing open quote for string");
 
-    if (parse.isChar('\''))
-      startChar = '\'';
+    startChar = *p;
   }
   else {
-    if (! parse.isChar('\"'))
+    if (p >= e || *p != '\"')
       return errorMsg(parse, "Missing double quote for string");
   }
 
-  parse.skipChar();
+  ++p;
 
-  while (! parse.eof()) {
-    if      (parse.isChar('\\') && ! parse.neof(1)) {
-      parse.skipChar();
+  // no escapes so use input chars directly
+  const char *p1 = CJsonScan::findQuoteOrEscape(p, e, startChar);
+
+  if (p1 < e && *p1 == startChar) {
+    str = std::string_view(p, size_t(p1 - p));
+
+    parse.setPtr(p1 + 1);
+
+    return true;
+  }
+
+  std::string &str1 = buffer;
+
+  str1.clear();
+
+  while (p < e) {
+    // copy run of plain chars up to next quote or escape
+    p1 = CJsonScan::findQuoteOrEscape(p, e, startChar);
+
+    str1.append(p, size_t(p1 - p));
+
+    p = p1;
 
-      char c = parse.readChar();
+    if (p >= e)
+      break;
+
+    if      (*p == '\\' && p + 1 < e) {
+      char c = p[1];
+
+      p += 2;
 
       switch (c) {
         case '\"': str1 += '\"'; break;
@@ -97,13 +273,13 @@ readString(CStrParse &parse, std::string &str1)
           // 4 hexadecimal digits
           long i = 0;
 
-          for (int j = 0; j < 4; ++j) {
-            if (! parse.isXDigit())
+          for (int j = 0; j < 4; ++j, ++p) {
+            if (p >= e || ! isxdigit(*p)) {
+              parse.setPtr(p);
               return errorMsg(parse, "Bad hex digit");
+            }
 
-            char c1 = parse.readChar();
-
-            i = (i << 4) | (hexCharValue(c1) & 0xF);
+            i = (i << 4) | (hexCharValue(*p) & 0xF);
           }
 
           CUtf8::append(str1, ulong(i));
@@ -111,8 +287,10 @@ readString(CStrParse &parse, std::string &str1)
           break;
         }
         default: {
-          if (isStrict())
+          if (isStrict()) {
+            parse.setPtr(p);
             return errorMsg(parse, "Bad char in string");
+          }
 
           str1 += c;
 
@@ -120,420 +298,990 @@ readString(CStrParse &parse, std::string &str1)
         }
       }
     }
-    else if (parse.isChar(startChar))
+    else if (*p == startChar)
       break;
     else
-      str1 += parse.readChar();
+      str1 += *p++;
   }
 
-  if (parse.eof() || ! parse.isChar(startChar))
+  parse.setPtr(p);
+
+  if (p >= e || *p != startChar)
     return errorMsg(parse, "Missing close quote for string");
 
-  parse.skipChar();
+  parse.setPtr(p + 1);
+
+  str = str1;
 
   return true;
 }
 
-// read numner at file pos
+// read number text at file pos (and accumulate decimal if specified)
 bool
 CJson::
-readNumber(CStrParse &parse, std::string &str1)
+readNumber(Parse &parse, std::string_view &text, CJsonNumber::Decimal *decimal)
 {
-  if (parse.eof())
+  const char *p = parse.ptr();
+  const char *e = parse.end();
+
+  const char *p1 = p;
+
+  auto error = [&]() {
+    parse.setPtr(p);
+    return errorMsg(parse, "Invalid number char");
+  };
+
+  if (p >= e)
     return errorMsg(parse, "Invalid number");
 
-  if (parse.isChar('-'))
-    str1 += parse.readChar();
+  // accumulate significant digits and decimal exponent while scanning
+  CJsonNumber::Decimal dummy;
+
+  bool convert = (decimal != nullptr);
+
+  if (! convert)
+    decimal = &dummy;
+
+  if (*p == '-') {
+    decimal->negative = true;
+
+    ++p;
+  }
 
   // TODO: octal, hexadecimal
-  if      (parse.isChar('0'))
-    str1 += parse.readChar();
-  else if (parse.isDigit()) {
-    while (parse.isDigit())
-      str1 += parse.readChar();
+  if      (p < e && *p == '0')
+    ++p;
+  else if (p < e && isDigitChar(*p)) {
+    while (p < e && isDigitChar(*p)) {
+      if (convert)
+        decimal->addDigit(*p - '0', false);
+
+      ++p;
+    }
   }
   else
-    return errorMsg(parse, "Invalid number char");
+    return error();
 
-  if (parse.isChar('.')) {
-    str1 += parse.readChar();
+  if (p < e && *p == '.') {
+    if (convert)
+      decimal->addPoint();
+
+    ++p;
 
     if (isStrict()) {
-      if (! parse.isDigit())
-        return errorMsg(parse, "Invalid number char");
+      if (p >= e || ! isDigitChar(*p))
+        return error();
     }
 
-    while (parse.isDigit())
-      str1 += parse.readChar();
+    while (p < e && isDigitChar(*p)) {
+      if (convert)
+        decimal->addDigit(*p - '0', true);
+
+      ++p;
+    }
   }
 
   // [Ee][+-][0-9][0-9]*
-  if (parse.isOneOf("eE")) {
-    str1 += parse.readChar();
+  if (p < e && (*p == 'e' || *p == 'E')) {
+    ++p;
 
-    if (parse.isOneOf("+-"))
-      str1 += parse.readChar();
+    bool negExp = false;
 
-    if (! parse.isDigit())
-      return errorMsg(parse, "Invalid number char");
+    if (p < e && (*p == '+' || *p == '-'))
+      negExp = (*p++ == '-');
 
-    while (parse.isDigit())
-      str1 += parse.readChar();
+    if (p >= e || ! isDigitChar(*p))
+      return error();
+
+    int exp = 0;
+
+    while (p < e && isDigitChar(*p)) {
+      if (exp < CJsonNumber::MAX_EXPONENT)
+        exp = exp*10 + (*p - '0');
+
+      ++p;
+    }
+
+    decimal->addExponent(negExp ? -exp : exp);
   }
 
+  text = std::string_view(p1, size_t(p - p1));
+
+  parse.setPtr(p);
+
   return true;
 }
 
-// read object at file pos
+// read value at file pos.
+//
+// Objects and arrays are read with an explicit stack of open containers
+// (no recursion) so deep input fails cleanly at the maximum depth.
+template<typename HANDLER>
 bool
 CJson::
-readObject(CStrParse &parse, Object *&obj)
+readValue(Parse &parse, HANDLER &handler)
 {
-  if (! parse.isChar('{'))
-    return errorMsg(parse, "Missing open brace for object");
+  ContainerStack stack;
 
-  bool open = false;
+  std::string buffer;
 
-  parse.skipChar();
+  size_t maxDepth = size_t(this->maxDepth());
 
-  obj = createObject();
+  while (true) {
+    // read value (object or array continues with first member or element)
+    if (parse.eof())
+      return errorMsg(parse, "Invalid char for value");
 
-  while (! parse.eof()) {
-    parse.skipSpace();
+    char c = *parse.ptr();
 
-    if (parse.isChar('}'))
-      break;
+    if (c == '{' || c == '[') {
+      bool isObject = (c == '{');
 
-    std::string name;
+      bool handled = false;
 
-    if (! readString(parse, name)) {
-      delete obj;
-      return false;
-    }
+      if constexpr (std::is_same<HANDLER, DomBuilder>::value) {
+        if      (parse.isLazy(handler.depth()) && readLazy(parse, handler))
+          handled = true;
+        else if (! isObject && parse.isParallel() && handler.depth() <= 1 &&
+                 readArrayParallel(parse, handler))
+          handled = true;
+      }
 
-    parse.skipSpace();
+      if (! handled) {
+        if (maxDepth > 0 && parse.depth() + stack.depth() >= maxDepth)
+          return errorMsg(parse, "Maximum depth exceeded");
 
-    if (! parse.isChar(':')) {
-      delete obj;
-      return errorMsg(parse, "Missing color separator for object");
-    }
+        parse.skipChar();
 
-    parse.skipChar();
+        if (! (isObject ? handler.startObject() : handler.startArray()))
+          return false;
 
-    parse.skipSpace();
+        if (parse.eof())
+          return errorMsg(parse, isObject ? "Missing close brace for object" :
+                                            "Missing close square bracket for array");
 
-    ValueP value;
+        parse.skipSpace();
 
-    if (! readValue(parse, value)) {
-      delete obj;
-      return false;
+        if (parse.isChar(isObject ? '}' : ']')) {
+          parse.skipChar();
+
+          if (! (isObject ? handler.endObject() : handler.endArray()))
+            return false;
+        }
+        else {
+          stack.push(isObject);
+
+          if (isObject && ! readMemberName(parse, handler, buffer))
+            return false;
+
+          continue;
+        }
+      }
+    }
+    else {
+      if (! readScalar(parse, handler, buffer))
+        return false;
     }
 
-    value->setParent(obj);
+    // value complete so close containers until next member or element
+    while (true) {
+      if (stack.empty())
+        return true;
 
-    parse.skipSpace();
+      bool isObject = stack.isObject();
 
-    obj->setNamedValue(name, value);
+      parse.skipSpace();
 
-    open = false;
+      if (parse.isChar(',')) {
+        parse.skipChar();
 
-    if (! parse.isChar(','))
-      break;
+        if (! parse.eof()) {
+          parse.skipSpace();
 
-    parse.skipChar();
+          if (! parse.isChar(isObject ? '}' : ']')) {
+            if (isObject && ! readMemberName(parse, handler, buffer))
+              return false;
 
-    open = true;
-  }
+            break;
+          }
+        }
 
-  if (open) {
-    delete obj;
-    return errorMsg(parse, "Missing data after comma for object");
-  }
+        return errorMsg(parse, isObject ? "Missing data after comma for object" :
+                                          "Missing value after command for array");
+      }
 
-  if (! parse.isChar('}')) {
-    delete obj;
-    return errorMsg(parse, "Missing close brace for object");
-  }
+      if (! parse.isChar(isObject ? '}' : ']'))
+        return errorMsg(parse, isObject ? "Missing close brace for object" :
+                                          "Missing close square bracket for array");
 
-  parse.skipChar();
+      parse.skipChar();
 
-  return true;
+      stack.pop();
+
+      if (! (isObject ? handler.endObject() : handler.endArray()))
+        return false;
+    }
+  }
 }
 
-// read array at file pos
+// read object member name and separator at file pos (at value after separator)
+template<typename HANDLER>
 bool
 CJson::
-readArray(CStrParse &parse, Array *&array)
+readMemberName(Parse &parse, HANDLER &handler, std::string &buffer)
 {
-  if (! parse.isChar('['))
-    return errorMsg(parse, "Missing open square bracket for array");
+  std::string_view name;
 
-  bool open = false;
+  if (! readString(parse, buffer, name))
+    return false;
+
+  if (! handler.key(name))
+    return false;
+
+  parse.skipSpace();
+
+  if (! parse.isChar(':'))
+    return errorMsg(parse, "Missing color separator for object");
 
   parse.skipChar();
 
-  array = createArray();
+  parse.skipSpace();
 
-  while (! parse.eof()) {
-    parse.skipSpace();
+  return true;
+}
 
-    if (parse.isChar(']'))
-      break;
+// read string, number or literal value at file pos
+template<typename HANDLER>
+bool
+CJson::
+readScalar(Parse &parse, HANDLER &handler, std::string &buffer)
+{
+  const char *p = parse.ptr();
+  const char *e = parse.end();
 
-    ValueP value;
+  char c = *p;
 
-    if (! readValue(parse, value)) {
-      delete array;
+  if      (c == '\"' || (c == '\'' && isAllowSingleQuote())) {
+    std::string_view str;
+
+    if (! readString(parse, buffer, str))
       return false;
+
+    return handler.string(str);
+  }
+  else if (c == '-' || isDigitChar(c)) {
+    if constexpr (std::is_same<HANDLER, DomBuilder>::value) {
+      if (handler.isRawNumbers()) {
+        std::string_view text;
+
+        if (! readNumber(parse, text))
+          return false;
+
+        return handler.rawNumber(text);
+      }
     }
 
-    value->setParent(array);
+    std::string_view     text;
+    CJsonNumber::Decimal decimal;
 
-    array->addValue(value);
+    if (! readNumber(parse, text, &decimal))
+      return false;
 
-    parse.skipSpace();
+    // exact integers skip double conversion
+    int64_t  i;
+    uint64_t u;
 
-    open = false;
+    switch (CJsonNumber::toInteger(decimal, text.data(), text.size(), i, u)) {
+      case CJsonNumber::IntegerType::INT64 : return handler.integer(i);
+      case CJsonNumber::IntegerType::UINT64: return handler.unsignedInteger(u);
+      default: break;
+    }
 
-    if (! parse.isChar(','))
-      break;
+    return handler.number(CJsonNumber::toDouble(decimal, text.data(), text.size()));
+  }
+  else if (c == 't' && isWord4(p, e, "true")) {
+    parse.setPtr(p + 4);
 
-    parse.skipChar();
+    return handler.boolean(true);
+  }
+  else if (c == 'f' && isWord4(p + 1, e, "alse")) {
+    parse.setPtr(p + 5);
 
-    open = true;
+    return handler.boolean(false);
   }
+  else if (c == 'n' && isWord4(p, e, "null")) {
+    parse.setPtr(p + 4);
 
-  if (open) {
-    delete array;
-    return errorMsg(parse, "Missing value after command for array");
+    return handler.null();
   }
+  else
+    return errorMsg(parse, "Invalid char for value");
+}
 
-  if (! parse.isChar(']')) {
-    delete array;
-    return errorMsg(parse, "Missing close square bracket for array");
+// read top level value and check for extra characters
+template<typename HANDLER>
+bool
+CJson::
+readRoot(Parse &parse, HANDLER &handler)
+{
+  if (maxSize() > 0 && size_t(parse.end() - parse.ptr()) > maxSize()) {
+    parse.setPtr(parse.ptr() + maxSize());
+
+    return errorMsg(parse, "Document too large");
   }
 
-  parse.skipChar();
+  parse.skipSpace();
+
+  if (! readValue(parse, handler))
+    return false;
+
+  parse.skipSpace();
+
+  if (! parse.eof())
+    return errorMsg(parse, "Extra characters for string");
 
   return true;
 }
 
-// read value at file pos
+//------
+
+// load file and return root value
 bool
 CJson::
-readValue(CStrParse &parse, ValueP &value)
+loadFile(const std::string &filename, ValueP &value)
 {
-  if (parse.eof())
-    return errorMsg(parse, "Invalid char for value");
-
-  char c = parse.getCharAt();
+  value = ValueP();
 
-  if      (c == '\"' || (c == '\'' && isAllowSingleQuote())) {
-    std::string str1;
+  releaseValues();
 
-    if (! readString(parse, str1))
-      return false;
+  auto fileData = std::make_shared<CJsonFileData>();
 
-    value = ValueP(createString(str1));
+  if (! fileData->open(filename, isMapFile())) {
+    if (! isQuiet())
+      std::cerr << "Failed to open file " << filename << "\n";
+    return false;
   }
-  else if (c == '-' || isdigit(c)) {
-    std::string str1;
 
-    if (! readNumber(parse, str1))
-      return false;
+  //---
 
-    bool ok;
+  // lazy values, zero copy strings and raw numbers keep the file data
+  if (isKeepData())
+    return loadKeptData(fileData, value);
 
-    double n = CJson::stod(str1, ok);
+  return loadRecord(fileData->data(), fileData->size(), value, /*quiet*/false);
+}
 
-    value = ValueP(createNumber(n));
-  }
-  else if (c == '{') {
-    Object *obj;
+bool
+CJson::
+loadString(const std::string &lines, ValueP &value)
+{
+  return loadData(lines.c_str(), lines.size(), value);
+}
 
-    if (! readObject(parse, obj))
-      return false;
+bool
+CJson::
+loadData(const char *data, size_t len, ValueP &value)
+{
+  releaseValues();
 
-    value = ValueP(obj);
-  }
-  else if (c == '[') {
-    Array *array;
+  // lazy values, zero copy strings and raw numbers need a copy of the data
+  if (isKeepData()) {
+    auto keepData = std::make_shared<CJsonFileData>();
 
-    if (! readArray(parse, array))
-      return false;
+    keepData->setData(data, len);
 
-    value = ValueP(array);
+    return loadKeptData(keepData, value);
   }
-  else if (parse.isString("true")) {
-    parse.skipChars("true");
 
-    value = ValueP(createTrue());
+  return loadRecord(data, len, value, /*quiet*/false);
+}
+
+bool
+CJson::
+loadKeptData(const DataP &data, ValueP &value)
+{
+  keepData(data);
+
+  return loadRecord(data->data(), data->size(), value, /*quiet*/false, data);
+}
+
+bool
+CJson::
+loadRecord(const char *data, size_t len, ValueP &value, bool quiet, const DataP &keepData,
+           Arena *arena)
+{
+  Parse parse(data, len);
+
+  parse.setQuiet(quiet);
+  parse.setParallel(isParallelLoad());
+
+  if (keepData) {
+    parse.setKeepData(keepData);
+
+    if (isLazyLoad() && ! isAllowSingleQuote())
+      parse.setLazyDepth(0);
   }
-  else if (parse.isString("false")) {
-    parse.skipChars("false");
 
-    value = ValueP(createFalse());
+  DomBuilder builder(this, arena ? arena : mainArena());
+
+  if (isZeroCopy())
+    builder.setDataView(parse.keepData());
+
+  if (isRawNumbers() && parse.keepData())
+    builder.setRawNumbers(true);
+
+  if (! readRoot(parse, builder))
+    return false;
+
+  value = builder.root();
+
+  return true;
+}
+
+// read large array at file pos using worker threads.
+//
+// The element boundaries are found with a fast scan (strings and brackets
+// only) and ranges of elements are parsed into values by the workers. Any
+// failure returns false so the array is parsed again normally to report
+// the error.
+bool
+CJson::
+readArrayParallel(Parse &parse, DomBuilder &builder)
+{
+  const char *p = parse.ptr();
+  const char *e = parse.end();
+
+  if (size_t(e - p) < s_parallelBytes)
+    return false;
+
+  uint numThreads = numWorkerThreads();
+
+  // element scan only handles double quoted strings
+  if (numThreads <= 1 || isAllowSingleQuote())
+    return false;
+
+  std::vector<const char *> seps;
+
+  const char *pe = CJsonScan::splitArray(p + 1, e, seps);
+
+  if (! pe || size_t(pe - p) < s_parallelBytes || seps.size() < 2)
+    return false;
+
+  //---
+
+  // split elements into chunks of similar size
+  struct Chunk {
+    size_t begin { 0 };
+    size_t end   { 0 };
+    Values values;
+  };
+
+  std::vector<Chunk> chunks;
+
+  size_t ne = seps.size();
+
+  size_t chunkBytes = size_t(pe - p)/(numThreads*s_parallelChunks) + 1;
+
+  const char *start = p + 1;
+
+  for (size_t i = 0; i < ne; ) {
+    Chunk chunk;
+
+    chunk.begin = i;
+
+    const char *chunkStart = start;
+
+    while (i < ne && size_t(seps[i] - chunkStart) < chunkBytes)
+      start = seps[i++] + 1;
+
+    if (i == chunk.begin)
+      start = seps[i++] + 1;
+
+    chunk.end = i;
+
+    chunks.push_back(std::move(chunk));
   }
-  else if (parse.isString("null")) {
-    parse.skipChars("null");
 
-    value = ValueP(createNull());
+  //---
+
+  std::atomic<size_t> nextChunk { 0 };
+  std::atomic<bool>   failed    { false };
+
+  auto worker = [&]() {
+    DomBuilder builder1(this, newArena());
+
+    if (isZeroCopy())
+      builder1.setDataView(parse.keepData());
+
+    builder1.setRawNumbers(builder.isRawNumbers());
+
+    while (! failed) {
+      size_t ic = nextChunk++;
+
+      if (ic >= chunks.size())
+        break;
+
+      auto &chunk = chunks[ic];
+
+      chunk.values.reserve(chunk.end - chunk.begin);
+
+      for (size_t i = chunk.begin; i < chunk.end; ++i) {
+        const char *p1 = (i > 0 ? seps[i - 1] + 1 : p + 1);
+
+        Parse parse1(parse.begin(), p1, seps[i]);
+
+        parse1.setQuiet(true);
+        parse1.setKeepData(parse.keepData());
+        parse1.setDepth(size_t(builder.depth()) + 1);
+
+        if (! readRoot(parse1, builder1)) {
+          failed = true;
+          break;
+        }
+
+        chunk.values.push_back(builder1.root());
+      }
+    }
+  };
+
+  numThreads = std::min(numThreads, uint(chunks.size()));
+
+  std::vector<std::thread> threads;
+
+  for (uint i = 0; i < numThreads; ++i)
+    threads.emplace_back(worker);
+
+  for (auto &thread : threads)
+    thread.join();
+
+  if (failed)
+    return false;
+
+  //---
+
+  Values values;
+
+  values.reserve(ne);
+
+  for (auto &chunk : chunks) {
+    for (auto &value : chunk.values)
+      values.push_back(std::move(value));
   }
-  else
-    return errorMsg(parse, "Invalid char for value");
+
+  builder.addArray(values);
+
+  parse.setPtr(pe + 1);
 
   return true;
 }
 
+// read object or array at file pos as lazy value.
+//
+// Only the end of the value is found (strings and brackets) and the range
+// is recorded in the value. If no end is found the value is read normally
+// to report the error.
 bool
 CJson::
-readLine(FILE *fp, std::string &line)
+readLazy(Parse &parse, DomBuilder &builder)
 {
-  line = "";
+  const char *p  = parse.ptr();
+  const char *pe = CJsonScan::skipContainer(p, parse.end());
 
-  if (feof(fp)) return false;
+  if (! pe)
+    return false;
 
-  int c = fgetc(fp);
+  builder.addLazy(p, pe);
 
-  while (! feof(fp) && c != '\n') {
-    line += char(c);
+  parse.setPtr(pe);
 
-    c = fgetc(fp);
+  return true;
+}
+
+// parse contents of lazy object or array (child objects and arrays are lazy)
+bool
+CJson::
+expandValue(Value *value, Arena *arena, const char *&begin, const char *&end)
+{
+  const char *p  = begin;
+  const char *pe = end;
+
+  // reset first so value is filled normally
+  begin = nullptr;
+  end   = nullptr;
+
+  auto data = findKeptData(p);
+  assert(data);
+
+  Parse parse(data->data(), p, pe);
+
+  parse.setKeepData(data);
+  parse.setLazyDepth(1);
+
+  DomBuilder builder(this, arena, value);
+
+  if (isZeroCopy())
+    builder.setDataView(data);
+
+  if (isRawNumbers())
+    builder.setRawNumbers(true);
+
+  if (! readValue(parse, builder)) {
+    // keep values read before error
+    builder.closeAll();
+    return false;
   }
 
   return true;
 }
 
-// load file and return root value
+// keep data until next load (for lazy load, zero copy and raw numbers)
+void
+CJson::
+keepData(const DataP &data)
+{
+  if (std::find(keptData_.begin(), keptData_.end(), data) == keptData_.end())
+    keptData_.push_back(data);
+}
+
+// get kept data containing pointer
+CJson::DataP
+CJson::
+findKeptData(const char *p) const
+{
+  for (const auto &data : keptData_) {
+    if (p >= data->data() && p < data->data() + data->size())
+      return data;
+  }
+
+  return DataP();
+}
+
+CJson::Arena *
+CJson::
+mainArena()
+{
+  return arenas_->mainArena();
+}
+
+CJson::Arena *
+CJson::
+newArena()
+{
+  return arenas_->newArena();
+}
+
+void
+CJson::
+releaseArena(Arena *arena)
+{
+  arenas_->releaseArena(arena);
+}
+
+void
+CJson::
+releaseResults()
+{
+  arenas_->releaseResults();
+}
+
+void
+CJson::
+releaseValues()
+{
+  arenas_ = std::make_unique<Arenas>();
+
+  keptData_.clear();
+}
+
+CJson::AllocStats
+CJson::
+allocStats() const
+{
+  return arenas_->stats();
+}
+
+//------
+
 bool
 CJson::
-loadFile(const std::string &filename, ValueP &value)
+setSymbols(const SymbolsP &symbols)
 {
-  value = ValueP();
+  if (symbols == symbols_)
+    return true;
 
-  FILE *fp = nullptr;
+  // names of existing objects would not be found in new table
+  if (symbols_->size() > 0) {
+    if (! isQuiet())
+      std::cerr << "Error: Symbol table set after names were added\n";
+    return false;
+  }
 
-  if (filename == "-")
-    fp = stdin;
-  else
-    fp = fopen(filename.c_str(), "r");
+  symbols_ = symbols;
+
+  return true;
+}
+
+CJson::Symbol
+CJson::
+findSymbol(std::string_view name) const
+{
+  Symbol symbol;
+
+  (void) symbols_->find(name, symbol);
+
+  return symbol;
+}
+
+//------
+
+bool
+CJson::
+parseFile(const std::string &filename, Handler &handler)
+{
+  CJsonFileData fileData;
 
-  if (! fp) {
+  if (! fileData.open(filename, isMapFile())) {
     if (! isQuiet())
       std::cerr << "Failed to open file " << filename << "\n";
     return false;
   }
 
-  std::string lines;
+  return parseData(fileData.data(), fileData.size(), handler);
+}
 
-  while (! feof(fp)) {
-    std::string line;
+bool
+CJson::
+parseString(const std::string &lines, Handler &handler)
+{
+  return parseData(lines.c_str(), lines.size(), handler);
+}
 
-    if (readLine(fp, line))
-      lines += line;
-  }
+bool
+CJson::
+parseData(const char *data, size_t len, Handler &handler)
+{
+  Parse parse(data, len);
 
-  fclose(fp);
+  return readRoot(parse, handler);
+}
 
-  //---
+//------
 
-  return loadString(lines, value);
+bool
+CJson::
+loadTapeFile(const std::string &filename, Tape &tape)
+{
+  CJsonFileData fileData;
+
+  if (! fileData.open(filename, isMapFile())) {
+    if (! isQuiet())
+      std::cerr << "Failed to open file " << filename << "\n";
+    return false;
+  }
+
+  return loadTapeData(fileData.data(), fileData.size(), tape);
 }
 
 bool
 CJson::
-loadString(const std::string &lines, ValueP &value)
+loadTapeString(const std::string &lines, Tape &tape)
 {
-  std::vector<std::string> strs;
+  return loadTapeData(lines.c_str(), lines.size(), tape);
+}
 
-  CStrParse parse(lines);
+bool
+CJson::
+loadTapeData(const char *data, size_t len, Tape &tape)
+{
+  Parse parse(data, len);
 
-  parse.skipSpace();
+  TapeBuilder builder(tape, len);
 
-  if      (parse.isChar('{')) { // object
-    Object *obj;
+  if (! readRoot(parse, builder)) {
+    if (builder.error())
+      (void) errorMsg(parse, builder.error());
 
-    if (! readObject(parse, obj))
-      return false;
+    tape.clear();
+    return false;
+  }
+
+  return true;
+}
+
+CJson::ValueP
+CJson::
+tapeValue(const Tape::Cursor &cursor)
+{
+  DomBuilder builder(this, mainArena());
+
+  if (! cursor.parse(builder))
+    return ValueP();
+
+  return builder.root();
+}
+
+//------
+
+namespace {
+
+// access to value tree (ValueP) and tape (Tape::Cursor) values for match functions
+template<typename NODE>
+struct MatchNode;
+
+template<>
+struct MatchNode<CJson::ValueP> {
+  using Node = CJson::ValueP;
+
+  static bool isObject(const Node &value) { return value->isObject(); }
+  static bool isArray (const Node &value) { return value->isArray (); }
+
+  static const char *typeName(const Node &value) { return value->typeName(); }
 
-    value = ValueP(obj);
+  // member name key (symbol so objects compare pointers). Name is kept for
+  // names which are not interned yet (lazy objects intern names on expand).
+  struct Key {
+    std::string_view name;
+    CJson::Symbol    symbol;
+  };
+
+  static Key key(CJson *json, const std::string &name) {
+    return Key { name, json->findSymbol(name) };
   }
-  else if (parse.isChar('[')) { // array
-    Array *array;
 
-    if (! readArray(parse, array))
-      return false;
+  static bool getNamedValue(const Node &value, const Key &key, Node &value1) {
+    auto *obj = value->cast<CJson::Object>();
+
+    if (! key.symbol.data())
+      return obj->getNamedValue(key.name, value1);
+
+    return obj->getSymbolValue(key.symbol, value1);
+  }
+
+  template<typename FUNC>
+  static void processNameValues(const Node &value, const FUNC &f) {
+    for (const auto &nv : value->cast<CJson::Object>()->nameValueArray())
+      f(nv.first, nv.second);
+  }
+
+  static size_t size(const Node &value) { return value->cast<CJson::Array>()->size(); }
+
+  // process array values with index in range i1 to i2
+  template<typename FUNC>
+  static void processRange(const Node &value, long i1, long i2, const FUNC &f) {
+    auto *array = value->cast<CJson::Array>();
+
+    long n = long(array->size());
+
+    for (long i = std::max(i1, 0L); i <= i2 && i < n; ++i)
+      f(int(i), array->at(uint(i)));
+  }
+
+  template<typename FUNC>
+  static void processValues(const Node &value, const FUNC &f) {
+    for (const auto &v : value->cast<CJson::Array>()->values())
+      f(v);
+  }
+
+  static CJson::ValueP toValue(CJson *, const Node &value) { return value; }
+};
+
+template<>
+struct MatchNode<CJson::Tape::Cursor> {
+  using Node = CJson::Tape::Cursor;
+
+  static bool isObject(const Node &value) { return value.isObject(); }
+  static bool isArray (const Node &value) { return value.isArray (); }
+
+  static const char *typeName(const Node &value) { return value.typeName(); }
+
+  // member name key (tape names are compared as strings)
+  using Key = std::string_view;
+
+  static Key key(CJson *, const std::string &name) { return name; }
+
+  static bool getNamedValue(const Node &value, const Key &key, Node &value1) {
+    return value.getNamedValue(key, value1);
+  }
+
+  template<typename FUNC>
+  static void processNameValues(const Node &value, const FUNC &f) {
+    for (const auto &nv : value.nameValueArray())
+      f(nv.first, nv.second);
+  }
+
+  static size_t size(const Node &value) { return value.size(); }
+
+  // process array values with index in range i1 to i2 (single pass as
+  // cursor index access is linear)
+  template<typename FUNC>
+  static void processRange(const Node &value, long i1, long i2, const FUNC &f) {
+    long i = 0;
 
-    value = ValueP(array);
-  }
-  else {
-    ValueP value1;
+    for (const auto &v : value.values()) {
+      if (i > i2)
+        break;
 
-    if (! readValue(parse, value1))
-      return false;
+      if (i >= i1)
+        f(int(i), v);
 
-    value = value1;
+      ++i;
+    }
   }
 
-  parse.skipSpace();
+  template<typename FUNC>
+  static void processValues(const Node &value, const FUNC &f) {
+    for (const auto &v : value.values())
+      f(v);
+  }
 
-  if (! parse.eof())
-    return errorMsg(parse, "Extra characters for string");
+  static CJson::ValueP toValue(CJson *json, const Node &value) { return json->tapeValue(value); }
+};
 
-  return true;
 }
 
-//------
-
+template<typename NODE>
 bool
 CJson::
-matchObject(const ValueP &value, const std::string &match, ValueP &value1)
+matchObject(const NODE &value, const std::string &match, NODE &value1, ValueP &result)
 {
+  using Node = MatchNode<NODE>;
+
   if (isDebug())
     std::cerr << "matchObject \'" << match << "\'" << std::endl;
 
-  if (! value->isObject()) {
+  if (! Node::isObject(value)) {
     if (! isQuiet())
-      std::cerr << value->typeName() << " is not an object" << std::endl;
+      std::cerr << Node::typeName(value) << " is not an object" << std::endl;
     return false;
   }
 
-  Object *obj = value->cast<Object>();
-
   if (match == "?" || match == "?keys") {
-    std::vector<std::string> names;
-
-    obj->getNames(names);
-
     Array *array = createArray();
 
-    for (const auto &n : names) {
-      String *str = createString(n);
+    Node::processNameValues(value, [&](std::string_view name, const NODE &) {
+      String *str = createString(name);
 
       array->addValue(ValueP(str));
-    }
+    });
 
-    value1 = ValueP(array);
+    result = ValueP(array);
   }
   else if (match == "?type") {
-    String *str = createString(obj->typeName());
+    String *str = createString(Node::typeName(value));
 
-    value1 = ValueP(str);
+    result = ValueP(str);
   }
   else if (match == "?values") {
-    Values values;
-
-    obj->getValues(values);
-
     Array *array = createArray();
 
-    for (const auto &v : values)
-      array->addValue(v);
+    Node::processNameValues(value, [&](std::string_view, const NODE &v) {
+      array->addValue(Node::toValue(this, v));
+    });
 
-   value1 = ValueP(array);
+    result = ValueP(array);
   }
   else {
-    if (! obj->getNamedValue(match, value1)) {
+    if (! Node::getNamedValue(value, Node::key(this, match), value1)) {
       if (! isQuiet())
         std::cerr << "no value \'" << match << "\'" << std::endl;
       return false;
@@ -543,28 +1291,29 @@ matchObject(const ValueP &value, const std::string &match, ValueP &value1)
   return true;
 }
 
+template<typename NODE>
 bool
 CJson::
-matchArray(const ValueP &value, const std::string &lhs, const std::string &rhs, Values &values)
+matchArray(const NODE &value, const std::string &lhs, const std::string &rhs, Values &values)
 {
+  using Node = MatchNode<NODE>;
+
   if (isDebug())
     std::cerr << "matchArray \'" << lhs << "\' \'" << rhs << "\'" << std::endl;
 
-  if (! value->isArray()) {
+  if (! Node::isArray(value)) {
     if (! isQuiet())
-      std::cerr << value->typeName() << " is not an array" << std::endl;
+      std::cerr << Node::typeName(value) << " is not an array" << std::endl;
     return false;
   }
 
-  Array *array = value->cast<Array>();
-
   if (lhs[0] != '[' || lhs[lhs.size() - 1] != ']')
     return false;
 
   std::string range = lhs.substr(1, lhs.size() - 2);
 
   if (range == "?size") {
-    Number *n = createNumber(array->size());
+    Number *n = createInteger(int64_t(Node::size(value)));
 
     values.push_back(ValueP(n));
 
@@ -590,14 +1339,12 @@ matchArray(const ValueP &value, const std::string &lhs, const std::string &rhs,
       return false;
     }
 
-    for (long i = i1; i <= i2 && i < long(array->size()); ++i) {
-      ValueP value1 = array->at(uint(i));
-
-      if (rhs1 != "")
-        matchValues(value1, int(i), rhs1, values);
+    Node::processRange(value, i1, i2, [&](int i, const NODE &value1) {
+      if (rhs != "")
+        matchNodeValues(value1, i, rhs, values);
       else
-        values.push_back(value1);
-    }
+        values.push_back(Node::toValue(this, value1));
+    });
   }
   else if (range != "") {
     bool ok;
@@ -612,36 +1359,37 @@ matchArray(const ValueP &value, const std::string &lhs, const std::string &rhs,
 
     int i = 0;
 
-    for (const auto &v : array->values()) {
+    Node::processValues(value, [&](const NODE &v) {
       if (i == i1) {
         if (rhs != "")
-          matchValues(v, i, rhs, values);
+          matchNodeValues(v, i, rhs, values);
         else
-          values.push_back(v);
+          values.push_back(Node::toValue(this, v));
       }
 
       ++i;
-    }
+    });
   }
   else {
     int i = 0;
 
-    for (const auto &v : array->values()) {
+    Node::processValues(value, [&](const NODE &v) {
       if (rhs != "")
-        matchValues(v, i, rhs, values);
+        matchNodeValues(v, i, rhs, values);
       else
-        values.push_back(v);
+        values.push_back(Node::toValue(this, v));
 
       ++i;
-    }
+    });
   }
 
   return true;
 }
 
+template<typename NODE>
 bool
 CJson::
-matchList(const ValueP &value, int ind, const std::string &lhs, const std::string &rhs,
+matchList(const NODE &value, int ind, const std::string &lhs, const std::string &rhs,
           Values &values)
 {
   if (isDebug())
@@ -675,7 +1423,7 @@ matchList(const ValueP &value, int ind, const std::string &lhs, const std::strin
 
     std::string match = (rhs != "" ? f + "/" + rhs : f);
 
-    matchValues(value, ind, match, values1);
+    matchNodeValues(value, ind, match, values1);
 
     for (const auto &v1 : values1)
       array->addValue(v1);
@@ -690,14 +1438,34 @@ bool
 CJson::
 matchValues(const ValueP &value, const std::string &match, Values &values)
 {
-  return matchValues(value, 0, match, values);
+  return matchNodeValues(value, 0, match, values);
 }
 
 bool
 CJson::
 matchValues(const ValueP &value, int ind, const std::string &match, Values &values)
 {
-  ValueP      value1 = value;
+  return matchNodeValues(value, ind, match, values);
+}
+
+bool
+CJson::
+matchValues(const Tape::Cursor &value, const std::string &match, Values &values)
+{
+  if (! value.isValid())
+    return false;
+
+  return matchNodeValues(value, 0, match, values);
+}
+
+template<typename NODE>
+bool
+CJson::
+matchNodeValues(const NODE &value, int ind, const std::string &match, Values &values)
+{
+  using Node = MatchNode<NODE>;
+
+  NODE        value1 = value;
   std::string match1 = match;
 
   auto p = match.find("...");
@@ -726,11 +1494,16 @@ matchValues(const ValueP &value, int ind, const std::string &match, Values &valu
         return matchList(value1, ind, lhs, rhs, values);
       }
       else {
-        ValueP value2;
+        NODE   value2;
+        ValueP result;
 
-        if (! matchObject(value1, lhs, value2))
+        if (! matchObject(value1, lhs, value2, result))
           return false;
 
+        // created value (keys, ...) is matched as a value tree
+        if (result)
+          return matchNodeValues(result, ind, rhs, values);
+
         value1 = value2;
       }
 
@@ -758,28 +1531,31 @@ matchValues(const ValueP &value, int ind, const std::string &match, Values &valu
       base = CJson::stol(match1.substr(1), ok);
     }
 
-    Number *n = createNumber(double(base + ind));
+    Number *n = createInteger(base + ind);
 
     values.push_back(ValueP(n));
   }
   else {
-    ValueP value2;
+    NODE   value2;
+    ValueP result;
 
-    if (! matchObject(value1, match1, value2))
+    if (! matchObject(value1, match1, value2, result))
       return false;
 
-    value1 = value2;
+    if (! result)
+      result = Node::toValue(this, value2);
 
-    if (value1)
-      values.push_back(value1);
+    if (result)
+      values.push_back(result);
   }
 
   return true;
 }
 
+template<typename NODE>
 bool
 CJson::
-matchHier(const ValueP &value, int ind, const std::string &name, const std::string &hname,
+matchHier(const NODE &value, int /*ind*/, const std::string &name, const std::string &hname,
           Values &values)
 {
   typedef std::vector<std::string> Keys;
@@ -812,60 +1588,64 @@ matchHier(const ValueP &value, int ind, const std::string &name, const std::stri
     keys.push_back(rhs1);
   }
 
+  // look up names once for whole hierarchy
+  using Node = MatchNode<NODE>;
+
+  std::vector<typename Node::Key> nodeKeys;
+
+  for (const auto &k : keys)
+    nodeKeys.push_back(Node::key(this, k));
+
   Values ivalues;
 
-  return matchHier1(value, ind, name, hname1, keys, ivalues, values);
+  return matchHier1(value, Node::key(this, name), Node::key(this, hname1), nodeKeys,
+                    ivalues, values);
 }
 
+template<typename NODE, typename KEY>
 bool
 CJson::
-matchHier1(const ValueP &value, int /*ind*/, const std::string &lhs, const std::string &rhs,
-           const std::vector<std::string> &keys, Values &ivalues, Values &values)
+matchHier1(const NODE &value, const KEY &lhs, const KEY &rhs, const std::vector<KEY> &keys,
+           Values &ivalues, Values &values)
 {
-  if (! value->isObject()) {
+  using Node = MatchNode<NODE>;
+
+  if (! Node::isObject(value)) {
     if (! isQuiet())
-      std::cerr << value->typeName() << " is not an object" << std::endl;
+      std::cerr << Node::typeName(value) << " is not an object" << std::endl;
     return false;
   }
 
-  Object *obj = value->cast<Object>();
-
   // name
-  ValueP lvalue;
+  NODE lvalue;
 
-  if (obj->getNamedValue(lhs, lvalue))
-    ivalues.push_back(lvalue);
+  if (Node::getNamedValue(value, lhs, lvalue))
+    ivalues.push_back(Node::toValue(this, lvalue));
 
   // hier object
-  ValueP rvalue;
+  NODE rvalue;
 
-  if (obj->getNamedValue(rhs, rvalue)) {
-    if (! rvalue->isArray()) {
+  if (Node::getNamedValue(value, rhs, rvalue)) {
+    if (! Node::isArray(rvalue)) {
       if (! isQuiet())
-        std::cerr << rvalue->typeName() << " is not an object" << std::endl;
+        std::cerr << Node::typeName(rvalue) << " is not an object" << std::endl;
       return false;
     }
 
-    Array *array = rvalue->cast<Array>();
-
-    int i = 0;
-
-    for (auto &v : array->values()) {
+    Node::processValues(rvalue, [&](const NODE &v) {
       Values ivalues1 = ivalues;
 
-      matchHier1(v, i, lhs, rhs, keys, ivalues1, values);
-
-      ++i;
-    }
+      matchHier1(v, lhs, rhs, keys, ivalues1, values);
+    });
   }
   else {
     Values kvalues;
 
     for (const auto &k : keys) {
-      ValueP kvalue;
+      NODE kvalue;
 
-      if (obj->getNamedValue(k, kvalue))
-        kvalues.push_back(kvalue);
+      if (Node::getNamedValue(value, k, kvalue))
+        kvalues.push_back(Node::toValue(this, kvalue));
     }
 
     String *str = hierValuesToKey(ivalues, kvalues);
@@ -891,7 +1671,7 @@ hierValuesToKey(const Values &values, const Values &kvalues)
     if      (v->isString())
       vstr += v->cast<String>()->value();
     else if (v->isNumber())
-      vstr += std::to_string(v->cast<Number>()->value());
+      vstr += v->cast<Number>()->to_string();
     else
       vstr += "??";
   }
@@ -906,7 +1686,7 @@ hierValuesToKey(const Values &values, const Values &kvalues)
       if      (k->isString())
         kstr += k->cast<String>()->value();
       else if (k->isNumber())
-        kstr += std::to_string(k->cast<Number>()->value());
+        kstr += k->cast<Number>()->to_string();
       else
         kstr += "??";
     }
@@ -921,9 +1701,9 @@ hierValuesToKey(const Values &values, const Values &kvalues)
 
 CJson::String *
 CJson::
-createString(const std::string &str)
+createString(std::string_view str, bool isView)
 {
-  auto *jstr = new String(this, str);
+  auto *jstr = arenas_->newResultValue<String>(this, str, isView);
 
   return jstr;
 }
@@ -932,7 +1712,16 @@ CJson::Number *
 CJson::
 createNumber(double r)
 {
-  auto *jnumber = new Number(this, r);
+  auto *jnumber = arenas_->newResultValue<Number>(this, r);
+
+  return jnumber;
+}
+
+CJson::Number *
+CJson::
+createInteger(int64_t i)
+{
+  auto *jnumber = arenas_->newResultValue<Number>(this, i);
 
   return jnumber;
 }
@@ -941,7 +1730,7 @@ CJson::True *
 CJson::
 createTrue()
 {
-  auto *jtrue = new True(this);
+  auto *jtrue = arenas_->newResultValue<True>(this);
 
   return jtrue;
 }
@@ -950,7 +1739,7 @@ CJson::False *
 CJson::
 createFalse()
 {
-  auto *jfalse = new False(this);
+  auto *jfalse = arenas_->newResultValue<False>(this);
 
   return jfalse;
 }
@@ -959,7 +1748,7 @@ CJson::Null *
 CJson::
 createNull()
 {
-  auto *jnull = new Null(this);
+  auto *jnull = arenas_->newResultValue<Null>(this);
 
   return jnull;
 }
@@ -968,7 +1757,7 @@ CJson::Object *
 CJson::
 createObject()
 {
-  auto *jobj = new Object(this);
+  auto *jobj = arenas_->newResultValue<Object>(this);
 
   return jobj;
 }
@@ -977,7 +1766,7 @@ CJson::Array *
 CJson::
 createArray()
 {
-  auto *jarray = new Array(this);
+  auto *jarray = arenas_->newResultValue<Array>(this);
 
   return jarray;
 }
@@ -986,17 +1775,27 @@ createArray()
 
 bool
 CJson::
-errorMsg(const CStrParse &parse, const std::string &msg) const
+errorMsg(const Parse &parse, const std::string &msg) const
+{
+  if (parse.isQuiet())
+    return false;
+
+  return errorMsg(parse.getPos(), msg);
+}
+
+bool
+CJson::
+errorMsg(size_t pos, const std::string &msg) const
 {
   if (! isQuiet())
-    std::cerr << "Error: " << msg << " (char " << parse.getPos() << ")\n";
+    std::cerr << "Error: " << msg << " (char " << pos << ")\n";
 
   return false;
 }
 
 //---
 
-std::string
+const char *
 CJson::
 printSep() const
 {
@@ -1007,7 +1806,7 @@ printSep() const
   return " ";
 }
 
-std::string
+const char *
 CJson::
 printPrefix(bool isArray) const
 {
@@ -1018,7 +1817,7 @@ printPrefix(bool isArray) const
   return (isArray ? "[" : "{");
 }
 
-std::string
+const char *
 CJson::
 printPostfix(bool isArray) const
 {
@@ -1029,93 +1828,455 @@ printPostfix(bool isArray) const
   return (isArray ? "]" : "}");
 }
 
-//------
+//------
+
+bool
+CJson::String::
+toReal(double &r) const
+{
+  bool ok;
+
+  r = CJson::stod(std::string(value()), ok);
+
+  return ok;
+}
+
+void
+CJson::String::
+print(Writer &writer) const
+{
+  if (json()->isPrintHtml()) {
+    // TODO: encode html
+    writer.write(value());
+  }
+  else {
+    writer.put('\"');
+    writer.write(value());
+    writer.put('\"');
+  }
+}
+
+void
+CJson::String::
+printReal(Writer &writer) const
+{
+  double r;
+
+  if (toReal(r))
+    writer.writeReal(r);
+  else
+    print(writer);
+}
+
+//------
+
+CJson::Number::
+Number(CJson *json, std::string_view text) :
+ Value(json, TYPE)
+{
+  auto ptr = uint64_t(reinterpret_cast<uintptr_t>(text.data()));
+
+  // convert now if text does not fit
+  if ((ptr & ~TEXT_PTR_MASK) || text.size() > (~uint64_t(0) >> TEXT_LEN_SHIFT)) {
+    real_ = CJsonNumber::parseDouble(text.data(), text.size());
+    return;
+  }
+
+  text_ = ptr | (uint64_t(text.size()) << TEXT_LEN_SHIFT);
+
+  setKind(Kind::TEXT);
+}
+
+double
+CJson::Number::
+textValue() const
+{
+  auto text = this->text();
+
+  return CJsonNumber::parseDouble(text.data(), text.size());
+}
+
+bool
+CJson::Number::
+isInteger() const
+{
+  switch (kind()) {
+    case Kind::INTEGER:
+    case Kind::UNSIGNED:
+      return true;
+    case Kind::TEXT: {
+      auto text = this->text();
+
+      int64_t  i;
+      uint64_t u;
+
+      return (CJsonNumber::parseInteger(text.data(), text.size(), i, u) !=
+              CJsonNumber::IntegerType::NONE);
+    }
+    default:
+      return false;
+  }
+}
+
+bool
+CJson::Number::
+isExactReal() const
+{
+  switch (kind()) {
+    case Kind::REAL:
+      return true;
+    case Kind::INTEGER:
+      return (integer_ >= -CJsonNumber::MAX_EXACT_INTEGER &&
+              integer_ <=  CJsonNumber::MAX_EXACT_INTEGER);
+    default:
+      return false;
+  }
+}
+
+bool
+CJson::Number::
+toInt64(int64_t &i) const
+{
+  switch (kind()) {
+    case Kind::INTEGER:
+      i = integer_;
+      return true;
+    case Kind::UNSIGNED:
+      return false;
+    case Kind::TEXT: {
+      auto text = this->text();
+
+      uint64_t u;
+
+      if (CJsonNumber::parseInteger(text.data(), text.size(), i, u) ==
+            CJsonNumber::IntegerType::INT64)
+        return true;
+
+      break;
+    }
+    default:
+      break;
+  }
+
+  return CJsonNumber::isIntegral(value(), i);
+}
+
+bool
+CJson::Number::
+toUInt64(uint64_t &u) const
+{
+  int64_t i;
+
+  switch (kind()) {
+    case Kind::UNSIGNED:
+      u = unsigned_;
+      return true;
+    case Kind::TEXT: {
+      auto text = this->text();
+
+      auto type = CJsonNumber::parseInteger(text.data(), text.size(), i, u);
+
+      if (type == CJsonNumber::IntegerType::UINT64)
+        return true;
+
+      if (type == CJsonNumber::IntegerType::NONE && ! CJsonNumber::isIntegral(value(), i))
+        return false;
+
+      break;
+    }
+    default:
+      if (! toInt64(i))
+        return false;
+
+      break;
+  }
+
+  if (i < 0)
+    return false;
+
+  u = uint64_t(i);
+
+  return true;
+}
+
+int
+CJson::Number::
+cmp(const Number &rhs) const
+{
+  // integers in int64 or uint64 range compare exactly (uint64 only values
+  // are larger than any int64)
+  int64_t  i1, i2;
+  uint64_t u1, u2;
+
+  bool isInt1 = toInt64(i1), isInt2 = rhs.toInt64(i2);
+
+  if (isInt1 && isInt2)
+    return (i1 < i2 ? -1 : (i1 > i2 ? 1 : 0));
+
+  bool isUInt1 = ! isInt1 && toUInt64(u1);
+  bool isUInt2 = ! isInt2 && rhs.toUInt64(u2);
+
+  if (isUInt1 && isUInt2)
+    return (u1 < u2 ? -1 : (u1 > u2 ? 1 : 0));
+
+  if (isInt1 && isUInt2) return -1;
+  if (isUInt1 && isInt2) return  1;
+
+  double r1 = value(), r2 = rhs.value();
+
+  return (r1 < r2 ? -1 : (r1 > r2 ? 1 : 0));
+}
+
+std::string
+CJson::Number::
+to_string() const
+{
+  Writer writer;
+
+  write(writer);
+
+  return writer.takeStr();
+}
+
+void
+CJson::Number::
+print(Writer &writer) const
+{
+  switch (kind()) {
+    case Kind::INTEGER : writer.writeInteger (integer_ ); break;
+    case Kind::UNSIGNED: writer.writeUnsigned(unsigned_); break;
+    case Kind::TEXT    : writer.write        (text()   ); break;
+    default            : writer.writeReal    (real_    ); break;
+  }
+}
+
+//------
+
+void
+CJson::True::
+print(Writer &writer) const
+{
+  if (json()->isPrintHtml())
+    writer.write("true");
+  else
+    writer.write("\"true\"");
+}
+
+//------
+
+void
+CJson::False::
+print(Writer &writer) const
+{
+  if (json()->isPrintHtml())
+    writer.write("false");
+  else
+    writer.write("\"false\"");
+}
+
+//------
+
+void
+CJson::Null::
+print(Writer &writer) const
+{
+  if (json()->isPrintHtml())
+    writer.write("null");
+  else
+    writer.write("\"null\"");
+}
+
+//------
+
+CJson::Shape::
+Shape(const Symbol *keys, size_t n, bool shared, Arena *arena) :
+ keys_(keys, keys + n, arena), index_(arena), shared_(shared)
+{
+  // index is built here and in addKey so lookups never change the shape
+  if (n > s_objectLinearNames)
+    buildIndex();
+}
+
+bool
+CJson::Shape::
+isKeys(const Symbol *keys, size_t n) const
+{
+  if (n != keys_.size())
+    return false;
+
+  for (size_t i = 0; i < n; ++i) {
+    if (keys_[i].data() != keys[i].data())
+      return false;
+  }
+
+  return true;
+}
+
+int
+CJson::Shape::
+find(Symbol symbol) const
+{
+  size_t n = keys_.size();
+
+  // small shape (search from end so last duplicate name is found)
+  if (n <= s_objectLinearNames) {
+    for (size_t i = n; i > 0; --i) {
+      if (keys_[i - 1].data() == symbol.data())
+        return int(i - 1);
+    }
+
+    return -1;
+  }
+
+  size_t mask = index_.size() - 1;
+
+  for (size_t h = symbolHash(symbol) & mask; index_[h]; h = (h + 1) & mask) {
+    size_t i = index_[h] - 1;
+
+    if (keys_[i].data() == symbol.data())
+      return int(i);
+  }
+
+  return -1;
+}
+
+int
+CJson::Shape::
+findName(std::string_view name, const Symbols &symbols) const
+{
+  size_t n = keys_.size();
+
+  // small shape (compare names from end so last duplicate name is found)
+  if (n <= s_objectLinearNames) {
+    for (size_t i = n; i > 0; --i) {
+      if (keys_[i - 1] == name)
+        return int(i - 1);
+    }
+
+    return -1;
+  }
 
-bool
-CJson::String::
-toReal(double &r) const
-{
-  bool ok;
+  // name can only be a key if it has been interned
+  Symbol symbol;
 
-  r = CJson::stod(str_, ok);
+  if (! symbols.find(name, symbol))
+    return -1;
 
-  return ok;
+  return find(symbol);
 }
 
 void
-CJson::String::
-print(std::ostream &os) const
+CJson::Shape::
+addKey(Symbol symbol)
 {
-  if (json_->isPrintHtml()) {
-    // TODO: encode html
-    os << str_;
-  }
+  assert(! shared_);
+
+  keys_.push_back(symbol);
+
+  size_t n = keys_.size();
+
+  if (n <= s_objectLinearNames)
+    return;
+
+  // rebuild larger table when more than half full
+  if (2*n > index_.size())
+    buildIndex();
   else
-    os << "\"" << str_ << "\"";
+    addIndex(n - 1);
 }
 
 void
-CJson::String::
-printReal(std::ostream &os) const
+CJson::Shape::
+buildIndex()
 {
-  double r;
+  size_t n = keys_.size();
 
-  if (toReal(r))
-    os << r;
-  else
-    print(os);
+  // table size is power of two at least twice number of keys
+  size_t size = 2*s_objectLinearNames;
+
+  while (size < 2*n)
+    size *= 2;
+
+  index_.assign(size, 0);
+
+  for (size_t i = 0; i < n; ++i)
+    addIndex(i);
 }
 
 void
-CJson::String::
-printShort(std::ostream &os) const
+CJson::Shape::
+addIndex(size_t i)
 {
-  os << str_;
+  size_t mask = index_.size() - 1;
+
+  auto symbol = keys_[i];
+
+  size_t h = symbolHash(symbol) & mask;
+
+  // replace previous key with same name
+  while (index_[h] && keys_[index_[h] - 1].data() != symbol.data())
+    h = (h + 1) & mask;
+
+  index_[h] = uint32_t(i + 1);
 }
 
 //------
 
-void
-CJson::Number::
-print(std::ostream &os) const
+CJson::Object::
+~Object()
 {
-  os << value_;
-}
+  // unshared shape is owned by object
+  if (shape_ && ! shape_->isShared()) {
+    auto *arena = values_.get_allocator().resource();
 
-//------
+    shape_->~Shape();
+
+    arena->deallocate(shape_, sizeof(Shape), alignof(Shape));
+  }
+}
 
 void
-CJson::True::
-print(std::ostream &os) const
+CJson::Object::
+setSymbolValue(Symbol symbol, const ValueP &value)
 {
-  if (json_->isPrintHtml())
-    os << "true";
-  else
-    os << "\"true\"";
-}
+  expand();
 
-//------
+  // changed object needs its own shape
+  if (! shape_ || shape_->isShared()) {
+    auto *arena = values_.get_allocator().resource();
+
+    void *p = arena->allocate(sizeof(Shape), alignof(Shape));
+
+    if (shape_)
+      shape_ = new (p) Shape(shape_->keys(), shape_->size(), /*shared*/false, arena);
+    else
+      shape_ = new (p) Shape(nullptr, 0, /*shared*/false, arena);
+  }
+
+  shape_->addKey(symbol);
+
+  values_.push_back(value);
+}
 
 void
-CJson::False::
-print(std::ostream &os) const
+CJson::Object::
+setShapeValues(Shape *shape, const ValueP *values, size_t n)
 {
-  if (json_->isPrintHtml())
-    os << "false";
-  else
-    os << "\"false\"";
-}
+  assert(values_.empty() && (shape ? shape->size() : 0) == n);
 
-//------
+  shape_ = shape;
 
-void
-CJson::Null::
-print(std::ostream &os) const
+  values_.assign(values, values + n);
+}
+
+int
+CJson::Object::
+findName(std::string_view name) const
 {
-  if (json_->isPrintHtml())
-    os << "null";
-  else
-    os << "\"null\"";
+  if (! shape_)
+    return -1;
+
+  return shape_->findName(name, *json_->symbols());
 }
 
 //------
@@ -1124,26 +2285,35 @@ std::string
 CJson::Object::
 to_string() const
 {
-  bool first = true;
+  Writer writer;
 
-  std::string str;
+  write(writer);
+
+  return writer.takeStr();
+}
+
+void
+CJson::Object::
+write(Writer &writer) const
+{
+  bool first = true;
 
-  str += "{";
+  writer.put('{');
 
-  for (const auto &nv : nameValueArray_) {
+  for (const auto &nv : nameValueArray()) {
     if (! first)
-      str += ",";
+      writer.put(',');
 
-    str += "\"" + nv.first + "\":";
+    writer.put('\"');
+    writer.write(nv.first);
+    writer.write("\":");
 
-    str += nv.second->to_string();
+    nv.second->write(writer);
 
     first = false;
   }
 
-  str += "}";
-
-  return str;
+  writer.put('}');
 }
 
 std::string
@@ -1163,7 +2333,7 @@ hierTypeName() const
 
   std::vector<std::string> types;
 
-  for (const auto &nv : nameValueArray_) {
+  for (const auto &nv : nameValueArray()) {
     std::string hierTypeName = nv.second->hierTypeName();
 
     if (types.empty() || types.back() != hierTypeName)
@@ -1190,7 +2360,7 @@ bool
 CJson::Object::
 isComposite() const
 {
-  for (const auto &nv : nameValueArray_) {
+  for (const auto &nv : nameValueArray()) {
     if (nv.second->isComposite())
       return true;
   }
@@ -1204,7 +2374,7 @@ numComposite() const
 {
   int n = 0;
 
-  for (const auto &nv : nameValueArray_) {
+  for (const auto &nv : nameValueArray()) {
     if (nv.second->isComposite())
       ++n;
   }
@@ -1214,99 +2384,218 @@ numComposite() const
 
 void
 CJson::Object::
-print(std::ostream &os) const
+print(Writer &writer) const
 {
   bool first = true;
 
-  os << json_->printPrefix();
+  writer.write(json()->printPrefix());
 
-  auto sep = json_->printSep();
+  auto sep = json()->printSep();
 
-  for (const auto &nv : nameValueArray_) {
-    if (! first) os << sep;
+  for (const auto &nv : nameValueArray()) {
+    if (! first) writer.write(sep);
 
-    if (! json_->isPrintHtml())
-      os << "\"" << nv.first << "\":";
+    if (! json()->isPrintHtml()) {
+      writer.put('\"');
+      writer.write(nv.first);
+      writer.write("\":");
+    }
     else
-      os << nv.first;
+      writer.write(nv.first);
 
-    if (json_->isPrintShort())
-      nv.second->printShort(os);
+    if (json()->isPrintShort())
+      nv.second->printShort(writer);
     else
-      nv.second->print(os);
+      nv.second->print(writer);
 
     first = false;
   }
 
-  os << json_->printPostfix();
+  writer.write(json()->printPostfix());
 }
 
 void
 CJson::Object::
-printReal(std::ostream &os) const
+printReal(Writer &writer) const
 {
   bool first = true;
 
-  os << json_->printPrefix();
+  writer.write(json()->printPrefix());
 
-  auto sep = json_->printSep();
+  auto sep = json()->printSep();
 
-  for (const auto &nv : nameValueArray_) {
-    if (! first) os << sep;
+  for (const auto &nv : nameValueArray()) {
+    if (! first) writer.write(sep);
 
-    os << "\"" << nv.first << "\":";
+    writer.put('\"');
+    writer.write(nv.first);
+    writer.write("\":");
 
-    nv.second->printReal(os);
+    nv.second->printReal(writer);
 
     first = false;
   }
 
-  os << json_->printPostfix();
+  writer.write(json()->printPostfix());
 }
 
 void
 CJson::Object::
-printName(std::ostream &os) const
+printName(Writer &writer) const
 {
   bool first = true;
 
-  os << json_->printPrefix();
+  writer.write(json()->printPrefix());
 
-  auto sep = json_->printSep();
+  auto sep = json()->printSep();
 
-  for (const auto &nv : nameValueArray_) {
-    if (! first) os << sep;
+  for (const auto &nv : nameValueArray()) {
+    if (! first) writer.write(sep);
 
-    os << nv.first;
+    writer.write(nv.first);
 
     first = false;
   }
 
-  os << json_->printPostfix();
+  writer.write(json()->printPostfix());
 }
 
 void
 CJson::Object::
-printValue(std::ostream &os) const
+printValue(Writer &writer) const
 {
   bool first = true;
 
-  os << json_->printPrefix();
+  writer.write(json()->printPrefix());
 
-  auto sep = json_->printSep();
+  auto sep = json()->printSep();
 
-  for (const auto &nv : nameValueArray_) {
-    if (! first) os << sep;
+  for (const auto &nv : nameValueArray()) {
+    if (! first) writer.write(sep);
 
-    if (json_->isPrintShort())
-      nv.second->printShort(os);
+    if (json()->isPrintShort())
+      nv.second->printShort(writer);
     else
-      nv.second->print(os);
+      nv.second->print(writer);
 
     first = false;
   }
 
-  os << json_->printPostfix();
+  writer.write(json()->printPostfix());
+}
+
+//------
+
+CJson::Array::
+~Array()
+{
+  auto *values = values_.load(std::memory_order_relaxed);
+
+  // number values created for numbers are in document's result arena
+  if (values && ! numbers_)
+    arena_->deallocate(values, capacity_*sizeof(ValueP), alignof(ValueP));
+
+  if (numbers_)
+    arena_->deallocate(numbers_, size_*sizeof(double), alignof(double));
+}
+
+void
+CJson::Array::
+addValue(const ValueP &value)
+{
+  // numbers are no longer stored separately
+  auto *values = this->values().begin();
+
+  // number values are not in array's arena (values are always reallocated
+  // as capacity is size)
+  bool ownValues = ! numbers_;
+
+  if (numbers_) {
+    arena_->deallocate(numbers_, size_*sizeof(double), alignof(double));
+
+    numbers_ = nullptr;
+  }
+
+  if (size_ >= capacity_) {
+    uint32_t capacity = std::max(2*capacity_, uint32_t(4));
+
+    auto *values1 = static_cast<ValueP *>(arena_->allocate(capacity*sizeof(ValueP), alignof(ValueP)));
+
+    std::uninitialized_copy(values, values + size_, values1);
+
+    if (values_ && ownValues)
+      arena_->deallocate(values_, capacity_*sizeof(ValueP), alignof(ValueP));
+
+    values_   = values1;
+    capacity_ = capacity;
+  }
+
+  new (&values_.load()[size_++]) ValueP(value);
+}
+
+void
+CJson::Array::
+setValues(const ValueP *values, size_t n)
+{
+  assert(size_ == 0 && ! values_);
+
+  if (n == 0)
+    return;
+
+  auto *values1 = static_cast<ValueP *>(arena_->allocate(n*sizeof(ValueP), alignof(ValueP)));
+
+  std::uninitialized_copy(values, values + n, values1);
+
+  values_   = values1;
+  size_     = uint32_t(n);
+  capacity_ = uint32_t(n);
+}
+
+void
+CJson::Array::
+setNumbers(const double *numbers, size_t n)
+{
+  assert(size_ == 0 && ! values_);
+
+  if (n == 0)
+    return;
+
+  numbers_ = static_cast<double *>(arena_->allocate(n*sizeof(double), alignof(double)));
+
+  memcpy(numbers_, numbers, n*sizeof(double));
+
+  size_ = uint32_t(n);
+}
+
+CJson::ValueP *
+CJson::Array::
+makeNumberValues() const
+{
+  // array's (load) arena may still be in use by its loading thread so values
+  // are allocated in document's (locked) result arena
+  auto *arenas = json_->arenas_.get();
+
+  auto *values  = static_cast<ValueP *>(arenas->allocateResult(size_*sizeof(ValueP), alignof(ValueP)));
+  auto *numbers = static_cast<Number *>(arenas->allocateResult(size_*sizeof(Number), alignof(Number)));
+
+  for (uint32_t i = 0; i < size_; ++i) {
+    auto *number = new (&numbers[i]) Number(json_, numbers_[i]);
+
+    number->setParent(const_cast<Array *>(this), i);
+
+    new (&values[i]) ValueP(number);
+  }
+
+  // values may have been created by another thread (use them)
+  ValueP *values1 = nullptr;
+
+  if (! values_.compare_exchange_strong(values1, values, std::memory_order_acq_rel,
+                                        std::memory_order_acquire))
+    return values1;
+
+  const_cast<Array *>(this)->capacity_ = size_;
+
+  return values;
 }
 
 //------
@@ -1315,24 +2604,43 @@ std::string
 CJson::Array::
 to_string() const
 {
-  bool first = true;
+  Writer writer;
 
-  std::string str;
+  write(writer);
 
-  str += "[";
+  return writer.takeStr();
+}
 
-  for (const auto &v : values_) {
-    if (! first)
-      str += ",";
+void
+CJson::Array::
+write(Writer &writer) const
+{
+  bool first = true;
 
-    str += v->to_string();
+  writer.put('[');
 
-    first = false;
+  if (isNumeric()) {
+    for (const auto &r : numbers()) {
+      if (! first)
+        writer.put(',');
+
+      writer.writeReal(r);
+
+      first = false;
+    }
   }
+  else {
+    for (const auto &v : values()) {
+      if (! first)
+        writer.put(',');
 
-  str += "]";
+      v->write(writer);
+
+      first = false;
+    }
+  }
 
-  return str;
+  writer.put(']');
 }
 
 std::string
@@ -1344,23 +2652,34 @@ to_name() const
 
 void
 CJson::Array::
-printReal(std::ostream &os) const
+printReal(Writer &writer) const
 {
   bool first = true;
 
-  os << json_->printPrefix(/*isArray*/true);
+  writer.write(json()->printPrefix(/*isArray*/true));
 
-  auto sep = json_->printSep();
+  auto sep = json()->printSep();
 
-  for (const auto &v : values_) {
-    if (! first) os << sep;
+  if (isNumeric()) {
+    for (const auto &r : numbers()) {
+      if (! first) writer.write(sep);
 
-    v->printReal(os);
+      writer.writeReal(r);
 
-    first = false;
+      first = false;
+    }
+  }
+  else {
+    for (const auto &v : values()) {
+      if (! first) writer.write(sep);
+
+      v->printReal(writer);
+
+      first = false;
+    }
   }
 
-  os << json_->printPostfix(/*isArray*/true);
+  writer.write(json()->printPostfix(/*isArray*/true));
 }
 
 //------
@@ -1369,13 +2688,16 @@ std::string
 CJson::Array::
 hierTypeName() const
 {
+  if (isNumeric())
+    return "[number]";
+
   std::string typeName;
 
   typeName += "[";
 
   std::vector<std::string> types;
 
-  for (const auto &v : values_) {
+  for (const auto &v : values()) {
     std::string hierTypeName = v->hierTypeName();
 
     if (types.empty() || types.back() != hierTypeName)
@@ -1400,32 +2722,47 @@ hierTypeName() const
 
 void
 CJson::Array::
-print(std::ostream &os) const
+print(Writer &writer) const
 {
-  // just print child array if flat and single array child
-  if (json_->isPrintFlat() && values_.size() == 1 && values_[0]->isArray()) {
-    values_[0]->print(os);
+  // just print child array if flat and single array child (numeric array has
+  // no array child so its number values are not created)
+  if (json()->isPrintFlat() && size() == 1 && ! isNumeric() && values()[0]->isArray()) {
+    values()[0]->print(writer);
     return;
   }
 
   bool first = true;
 
-  os << json_->printPrefix(/*isArray*/true);
+  writer.write(json()->printPrefix(/*isArray*/true));
+
+  auto sep = json()->printSep();
+
+  if (isNumeric()) {
+    for (const auto &r : numbers()) {
+      if (! first) writer.write(sep);
+
+      writer.writeReal(r);
 
-  auto sep = json_->printSep();
+      first = false;
+    }
+
+    writer.write(json()->printPostfix(/*isArray*/true));
+
+    return;
+  }
 
-  for (const auto &v : values_) {
-    if (! first) os << sep;
+  for (const auto &v : values()) {
+    if (! first) writer.write(sep);
 
-    if (json_->isPrintShort())
-      v->printShort(os);
+    if (json()->isPrintShort())
+      v->printShort(writer);
     else
-      v->print(os);
+      v->print(writer);
 
     first = false;
   }
 
-  os << json_->printPostfix(/*isArray*/true);
+  writer.write(json()->printPostfix(/*isArray*/true));
 }
 
 //---
@@ -1440,6 +2777,20 @@ hier_name() const
     return to_name();
 }
 
+std::string
+CJson::Value::
+parentName() const
+{
+  auto *parent = this->parent();
+
+  if      (! parent)
+    return "";
+  else if (parent->isObject())
+    return std::string(parent->cast<Object>()->shape()->key(parentIndex()));
+  else
+    return std::to_string(parentIndex());
+}
+
 uint
 CJson::Value::
 hier_depth() const
@@ -1449,3 +2800,178 @@ hier_depth() const
   else
     return 0;
 }
+
+//---
+
+// dispatch to implementation for value type
+
+uint
+CJson::Value::
+numValues() const
+{
+  switch (type()) {
+    case ValueType::VALUE_OBJECT: return cast<Object>()->numValues();
+    case ValueType::VALUE_ARRAY : return cast<Array >()->numValues();
+    default                     : return 1;
+  }
+}
+
+std::string
+CJson::Value::
+indexKey(uint i)
+{
+  switch (type()) {
+    case ValueType::VALUE_OBJECT: return cast<Object>()->indexKey(i);
+    case ValueType::VALUE_ARRAY : return cast<Array >()->indexKey(i);
+    default                     : assert(i == 0); return "";
+  }
+}
+
+CJson::ValueP
+CJson::Value::
+indexValue(uint i)
+{
+  switch (type()) {
+    case ValueType::VALUE_OBJECT: return cast<Object>()->indexValue(i);
+    case ValueType::VALUE_ARRAY : return cast<Array >()->indexValue(i);
+    default                     : assert(i == 0); return ValueP();
+  }
+}
+
+const char *
+CJson::Value::
+typeName() const
+{
+  switch (type()) {
+    case ValueType::VALUE_NONE: return "value";
+    default                   : return CJson::typeName(type());
+  }
+}
+
+std::string
+CJson::Value::
+hierTypeName() const
+{
+  switch (type()) {
+    case ValueType::VALUE_OBJECT: return cast<Object>()->hierTypeName();
+    case ValueType::VALUE_ARRAY : return cast<Array >()->hierTypeName();
+    default                     : return typeName();
+  }
+}
+
+std::string
+CJson::Value::
+to_string() const
+{
+  switch (type()) {
+    case ValueType::VALUE_STRING: return cast<String>()->to_string();
+    case ValueType::VALUE_NUMBER: return cast<Number>()->to_string();
+    case ValueType::VALUE_TRUE  : return cast<True  >()->to_string();
+    case ValueType::VALUE_FALSE : return cast<False >()->to_string();
+    case ValueType::VALUE_NULL  : return cast<Null  >()->to_string();
+    case ValueType::VALUE_OBJECT: return cast<Object>()->to_string();
+    case ValueType::VALUE_ARRAY : return cast<Array >()->to_string();
+    default                     : assert(false); return "";
+  }
+}
+
+void
+CJson::Value::
+write(Writer &writer) const
+{
+  switch (type()) {
+    case ValueType::VALUE_STRING: cast<String>()->write(writer); break;
+    case ValueType::VALUE_NUMBER: cast<Number>()->write(writer); break;
+    case ValueType::VALUE_TRUE  : cast<True  >()->write(writer); break;
+    case ValueType::VALUE_FALSE : cast<False >()->write(writer); break;
+    case ValueType::VALUE_NULL  : cast<Null  >()->write(writer); break;
+    case ValueType::VALUE_OBJECT: cast<Object>()->write(writer); break;
+    case ValueType::VALUE_ARRAY : cast<Array >()->write(writer); break;
+    default                     : assert(false); break;
+  }
+}
+
+std::string
+CJson::Value::
+to_name() const
+{
+  switch (type()) {
+    case ValueType::VALUE_OBJECT: return cast<Object>()->to_name();
+    case ValueType::VALUE_ARRAY : return cast<Array >()->to_name();
+    default                     : return to_string();
+  }
+}
+
+void
+CJson::Value::
+print(Writer &writer) const
+{
+  switch (type()) {
+    case ValueType::VALUE_STRING: cast<String>()->print(writer); break;
+    case ValueType::VALUE_NUMBER: cast<Number>()->print(writer); break;
+    case ValueType::VALUE_TRUE  : cast<True  >()->print(writer); break;
+    case ValueType::VALUE_FALSE : cast<False >()->print(writer); break;
+    case ValueType::VALUE_NULL  : cast<Null  >()->print(writer); break;
+    case ValueType::VALUE_OBJECT: cast<Object>()->print(writer); break;
+    case ValueType::VALUE_ARRAY : cast<Array >()->print(writer); break;
+    default                     : assert(false); break;
+  }
+}
+
+void
+CJson::Value::
+printReal(Writer &writer) const
+{
+  switch (type()) {
+    case ValueType::VALUE_STRING: cast<String>()->printReal(writer); break;
+    case ValueType::VALUE_OBJECT: cast<Object>()->printReal(writer); break;
+    case ValueType::VALUE_ARRAY : cast<Array >()->printReal(writer); break;
+    default                     : print(writer); break;
+  }
+}
+
+void
+CJson::Value::
+printShort(Writer &writer) const
+{
+  switch (type()) {
+    case ValueType::VALUE_STRING: cast<String>()->printShort(writer); break;
+    default                     : print(writer); break;
+  }
+}
+
+void
+CJson::Value::
+printName(Writer &writer) const
+{
+  switch (type()) {
+    case ValueType::VALUE_OBJECT: cast<Object>()->printName(writer); break;
+    default                     : print(writer); break;
+  }
+}
+
+void
+CJson::Value::
+printValue(Writer &writer) const
+{
+  switch (type()) {
+    case ValueType::VALUE_OBJECT: cast<Object>()->printValue(writer); break;
+    default                     : print(writer); break;
+  }
+}
+
+void
+CJson::Value::
+destroy(Value *value)
+{
+  switch (value->type()) {
+    case ValueType::VALUE_STRING: value->cast<String>()->~String(); break;
+    case ValueType::VALUE_NUMBER: value->cast<Number>()->~Number(); break;
+    case ValueType::VALUE_TRUE  : value->cast<True  >()->~True  (); break;
+    case ValueType::VALUE_FALSE : value->cast<False >()->~False (); break;
+    case ValueType::VALUE_NULL  : value->cast<Null  >()->~Null  (); break;
+    case ValueType::VALUE_OBJECT: value->cast<Object>()->~Object(); break;
+    case ValueType::VALUE_ARRAY : value->cast<Array >()->~Array (); break;
+    default                     : value->~Value(); break;
+  }
+}
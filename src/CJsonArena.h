@@ -0,0 +1,187 @@
+#ifndef CJsonArena_H
+#define CJsonArena_H
+
+#include <CJson.h>
+#include <algorithm>
+#include <cassert>
+#include <mutex>
+#include <type_traits>
+
+// Arenas for values owned by a CJson.
+//
+// Each arena is a bump allocator (monotonic buffer) used by a single
+// loading thread so parallel loads do not contend. Query result values use
+// a separate (locked) arena. Values in an arena are never destroyed
+// individually, all memory is released with the arenas (or with a single
+// arena or the results, see releaseArena and releaseResults).
+//
+// Arenas count their allocations (see CJson::allocStats).
+class CJson::Arenas {
+ private:
+  // initial block size (blocks grow geometrically)
+  static constexpr size_t s_blockSize = 64*1024;
+
+ public:
+  // monotonic buffer which counts allocations (counts are not locked so
+  // are only valid when the arena's thread is not allocating)
+  class Arena : public std::pmr::memory_resource {
+   public:
+    Arena() { }
+
+    const AllocStats &stats() const { return stats_; }
+
+    // release all allocated memory (and reset counts)
+    void release() {
+      buffer_.release();
+
+      stats_ = AllocStats();
+    }
+
+   private:
+    void *do_allocate(size_t bytes, size_t align) override {
+      ++stats_.count;
+
+      stats_.bytes += bytes;
+
+      return buffer_.allocate(bytes, align);
+    }
+
+    void do_deallocate(void *p, size_t bytes, size_t align) override {
+      buffer_.deallocate(p, bytes, align);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource &rhs) const noexcept override {
+      return this == &rhs;
+    }
+
+   private:
+    std::pmr::monotonic_buffer_resource buffer_ { s_blockSize };
+    AllocStats                          stats_;
+  };
+
+  Arenas() { }
+
+ ~Arenas() {
+    for (auto *value : resultValues_)
+      Value::destroy(value);
+  }
+
+  Arenas(const Arenas &) = delete;
+  Arenas &operator=(const Arenas &) = delete;
+
+  // arena for main (loading) thread
+  Arena *mainArena() {
+    if (! mainArena_)
+      mainArena_ = newArena();
+
+    return mainArena_;
+  }
+
+  // new arena for a worker thread
+  Arena *newArena() {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    arenas_.push_back(std::make_unique<Arena>());
+
+    return arenas_.back().get();
+  }
+
+  // release arena (and all values in it) before the other arenas
+  void releaseArena(CJson::Arena *arena) {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    auto p = std::find_if(arenas_.begin(), arenas_.end(),
+                          [&](const ArenaP &arena1) { return arena1.get() == arena; });
+    assert(p != arenas_.end() && p->get() != mainArena_);
+
+    arenas_.erase(p);
+  }
+
+  // construct value in arena
+  template<typename T, typename... ARGS>
+  static T *newValue(CJson::Arena *arena, CJson *json, const ARGS &... args) {
+    void *p = arena->allocate(sizeof(T), alignof(T));
+
+    if constexpr (std::is_constructible<T, CJson *, ARGS..., CJson::Arena *>::value)
+      return new (p) T(json, args..., arena);
+    else
+      return new (p) T(json, args...);
+  }
+
+  // construct query result value (thread safe). Child storage uses the
+  // default resource (results are updated after creation, outside the lock)
+  // so the values are destroyed with the arenas.
+  template<typename T, typename... ARGS>
+  T *newResultValue(CJson *json, const ARGS &... args) {
+    std::unique_lock<std::mutex> lock(resultMutex_);
+
+    void *p = resultArena_.allocate(sizeof(T), alignof(T));
+
+    auto *t = new (p) T(json, args...);
+
+    resultValues_.push_back(t);
+
+    return t;
+  }
+
+  // allocate from query result arena (thread safe). For values created on
+  // demand for loaded values (they are released with the arenas and are not
+  // destroyed)
+  void *allocateResult(size_t bytes, size_t align) {
+    std::unique_lock<std::mutex> lock(resultMutex_);
+
+    return resultArena_.allocate(bytes, align);
+  }
+
+  // release query result values and values created on demand for loaded
+  // values (none of them may be in use)
+  void releaseResults() {
+    std::unique_lock<std::mutex> lock(resultMutex_);
+
+    for (auto *value : resultValues_)
+      Value::destroy(value);
+
+    resultValues_.clear();
+
+    resultArena_.release();
+  }
+
+  // total allocations of all arenas
+  AllocStats stats() {
+    AllocStats stats;
+
+    auto add = [&](const AllocStats &stats1) {
+      stats.count += stats1.count;
+      stats.bytes += stats1.bytes;
+    };
+
+    {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    for (const auto &arena : arenas_)
+      add(arena->stats());
+    }
+
+    {
+    std::unique_lock<std::mutex> lock(resultMutex_);
+
+    add(resultArena_.stats());
+    }
+
+    return stats;
+  }
+
+ private:
+  using ArenaP = std::unique_ptr<Arena>;
+
+  std::mutex          mutex_;
+  std::vector<ArenaP> arenas_;
+  Arena*              mainArena_ { nullptr };
+
+  // query result values
+  std::mutex           resultMutex_;
+  Arena                resultArena_;
+  std::vector<Value *> resultValues_;
+};
+
+#endif
@@ -0,0 +1,408 @@
+#ifndef CJsonDomBuilder_H
+#define CJsonDomBuilder_H
+
+#include <CJson.h>
+#include <CJsonArena.h>
+#include <CJsonFileData.h>
+#include <CJsonNumber.h>
+#include <CJsonShapes.h>
+#include <array>
+
+// handler to build value tree from parse events
+class CJson::DomBuilder final : public CJson::Handler {
+ public:
+  // values are allocated in arena (not thread safe so one per thread)
+  // target is existing (lazy) object or array to fill for top level value
+  DomBuilder(CJson *json, Arena *arena, Value *target=nullptr) :
+   json_(json), arena_(arena), target_(target), symbols_(json->symbols().get()) {
+  }
+
+  const ValueP &root() const { return root_; }
+
+  // number of open objects/arrays
+  int depth() const { return int(stack_.size()); }
+
+  // add object members as they are read (tree is complete after each event)
+  // instead of when the object ends (shared shapes)
+  void setIncremental(bool b) { incremental_ = b; }
+
+  // add members read so far to open objects (after failed parse)
+  void closeAll() {
+    while (! stack_.empty()) {
+      if (stack_.back().value->isObject())
+        (void) endObject();
+      else
+        (void) endArray();
+    }
+  }
+
+  // strings in data are referenced by values (zero copy)
+  void setDataView(const DataP &data) {
+    if (! data) return;
+
+    viewBegin_ = data->data();
+    viewEnd_   = viewBegin_ + data->size();
+  }
+
+  // create numbers from their text (in kept data)
+  void setRawNumbers(bool b) { rawNumbers_ = b; }
+  bool isRawNumbers() const { return rawNumbers_; }
+
+  bool startObject() override {
+    if (target_) {
+      pushFrame(target_);
+
+      target_ = nullptr;
+
+      return true;
+    }
+
+    auto *obj = addNew<Object>();
+
+    pushFrame(obj);
+
+    return true;
+  }
+
+  bool key(std::string_view name) override {
+    // recently used names are cached to avoid locking the (shared) symbol table
+    size_t h = std::hash<std::string_view>()(name) & (s_symbolCacheSize - 1);
+
+    auto &symbol = symbolCache_[h];
+
+    if (! symbol.data() || symbol != name)
+      symbol = symbols_->intern(name);
+
+    key_ = symbol;
+
+    return true;
+  }
+
+  bool endObject() override {
+    if (incremental_) {
+      stack_.pop_back();
+      return true;
+    }
+
+    // members are added when object is complete (to use shared shape)
+    const auto &frame = stack_.back();
+
+    size_t n = keys_.size() - frame.keyStart;
+
+    const Symbol *keys   = keys_  .data() + frame.keyStart;
+    const ValueP *values = values_.data() + frame.valueStart;
+
+    auto *obj = static_cast<Object *>(frame.value);
+
+    obj->setShapeValues(n > 0 ? shape(keys, n) : nullptr, values, n);
+
+    keys_  .resize(frame.keyStart);
+    values_.resize(frame.valueStart);
+
+    stack_.pop_back();
+
+    return true;
+  }
+
+  bool startArray() override {
+    if (target_) {
+      pushFrame(target_);
+
+      target_ = nullptr;
+
+      return true;
+    }
+
+    auto *array = addNew<Array>();
+
+    pushFrame(array);
+
+    return true;
+  }
+
+  bool endArray() override {
+    if (incremental_) {
+      stack_.pop_back();
+      return true;
+    }
+
+    // values are added when array is complete (numbers stored contiguously
+    // if all values are numbers)
+    const auto &frame = stack_.back();
+
+    auto *array = static_cast<Array *>(frame.value);
+
+    if (frame.numeric) {
+      size_t n = numbers_.size() - frame.numberStart;
+
+      array->setNumbers(numbers_.data() + frame.numberStart, n);
+
+      numbers_.resize(frame.numberStart);
+    }
+    else {
+      size_t n = values_.size() - frame.valueStart;
+
+      array->setValues(values_.data() + frame.valueStart, n);
+
+      values_.resize(frame.valueStart);
+    }
+
+    stack_.pop_back();
+
+    return true;
+  }
+
+  // add array of already built values
+  void addArray(const Values &values) {
+    auto *array = addNew<Array>();
+
+    bool numeric = ! values.empty();
+
+    for (const auto &value : values) {
+      if (! value->isNumber() || ! value->cast<Number>()->isExactReal()) {
+        numeric = false;
+        break;
+      }
+    }
+
+    if (numeric) {
+      std::vector<double> numbers;
+
+      numbers.reserve(values.size());
+
+      for (const auto &value : values)
+        numbers.push_back(value->toNumber());
+
+      array->setNumbers(numbers.data(), numbers.size());
+    }
+    else {
+      for (size_t i = 0; i < values.size(); ++i)
+        values[i]->setParent(array, uint(i));
+
+      array->setValues(values.data(), values.size());
+    }
+  }
+
+  // add object or array whose contents [begin, end) are parsed later
+  void addLazy(const char *begin, const char *end) {
+    if (*begin == '{')
+      addNew<Object>()->setLazy(begin, end);
+    else
+      addNew<Array>()->setLazy(begin, end);
+  }
+
+  bool string(std::string_view str) override {
+    addNew<String>(str, isDataView(str));
+
+    return true;
+  }
+
+  bool number(double r) override {
+    // no value is created for number in numeric array
+    if (! stack_.empty() && stack_.back().numeric) {
+      numbers_.push_back(r);
+      return true;
+    }
+
+    addNew<Number>(r);
+
+    return true;
+  }
+
+  bool integer(int64_t i) override {
+    // integer is stored in numeric array if double holds it exactly
+    if (! stack_.empty() && stack_.back().numeric &&
+        i >= -CJsonNumber::MAX_EXACT_INTEGER && i <= CJsonNumber::MAX_EXACT_INTEGER) {
+      numbers_.push_back(double(i));
+      return true;
+    }
+
+    addNew<Number>(i);
+
+    return true;
+  }
+
+  bool unsignedInteger(uint64_t u) override {
+    addNew<Number>(u);
+
+    return true;
+  }
+
+  // number which keeps its text (arrays containing it are not numeric)
+  bool rawNumber(std::string_view text) {
+    addNew<Number>(text);
+
+    return true;
+  }
+
+  bool boolean(bool b) override {
+    if (b)
+      addNew<True>();
+    else
+      addNew<False>();
+
+    return true;
+  }
+
+  bool null() override {
+    addNew<Null>();
+
+    return true;
+  }
+
+ private:
+  // open object or array (with start of its members in keys_, values_ and
+  // numbers_). Array is numeric until a value which is not a number is added.
+  struct Frame {
+    Value* value       { nullptr };
+    size_t keyStart    { 0 };
+    size_t valueStart  { 0 };
+    size_t numberStart { 0 };
+    bool   numeric     { false };
+  };
+
+  // check if string is in viewed data
+  bool isDataView(std::string_view str) const {
+    return (str.data() >= viewBegin_ && str.data() + str.size() <= viewEnd_ && viewBegin_);
+  }
+
+  // create value in arena and add to current object or array
+  template<typename T, typename... ARGS>
+  T *addNew(const ARGS &... args) {
+    auto *t = Arenas::newValue<T>(arena_, json_, args...);
+
+    addValue(ValueP(t));
+
+    return t;
+  }
+
+  // add value to current object (for last key) or array
+  void addValue(const ValueP &value) {
+    if (stack_.empty()) {
+      root_ = value;
+      return;
+    }
+
+    auto *parent = stack_.back().value;
+
+    if (incremental_) {
+      if (parent->isObject()) {
+        auto *obj = static_cast<Object *>(parent);
+
+        value->setParent(obj, obj->numValues());
+
+        obj->setSymbolValue(key_, value);
+      }
+      else {
+        auto *array = static_cast<Array *>(parent);
+
+        value->setParent(array, array->size());
+
+        array->addValue(value);
+      }
+
+      return;
+    }
+
+    auto &frame = stack_.back();
+
+    if (parent->isObject())
+      keys_.push_back(key_);
+    else if (frame.numeric)
+      addNumberValues(frame);
+
+    value->setParent(parent, uint(values_.size() - frame.valueStart));
+
+    values_.push_back(value);
+  }
+
+  // create values for numbers of array which is not numeric
+  void addNumberValues(Frame &frame) {
+    auto *array = static_cast<Array *>(frame.value);
+
+    for (size_t i = frame.numberStart; i < numbers_.size(); ++i) {
+      auto *number = Arenas::newValue<Number>(arena_, json_, numbers_[i]);
+
+      number->setParent(array, uint(i - frame.numberStart));
+
+      values_.push_back(ValueP(number));
+    }
+
+    numbers_.resize(frame.numberStart);
+
+    frame.numeric = false;
+  }
+
+  void pushFrame(Value *value) {
+    Frame frame;
+
+    frame.value       = value;
+    frame.keyStart    = keys_.size();
+    frame.valueStart  = values_.size();
+    frame.numberStart = numbers_.size();
+    frame.numeric     = (value->isArray() && ! incremental_);
+
+    stack_.push_back(frame);
+  }
+
+  // get shape for object keys. The last shape at each depth is cached
+  // (arrays of records have the same layout).
+  Shape *shape(const Symbol *keys, size_t n) {
+    size_t depth = stack_.size();
+
+    if (shapeCache_.size() < depth)
+      shapeCache_.resize(depth);
+
+    auto &cacheShape = shapeCache_[depth - 1];
+
+    if (cacheShape && cacheShape->isKeys(keys, n))
+      return cacheShape;
+
+    auto *shape = json_->shapes_->shape(keys, n);
+
+    if (! shape) {
+      // unshared shape in arena
+      void *p = arena_->allocate(sizeof(Shape), alignof(Shape));
+
+      return new (p) Shape(keys, n, /*shared*/false, arena_);
+    }
+
+    cacheShape = shape;
+
+    return shape;
+  }
+
+ private:
+  using Stack        = std::vector<Frame>;
+  using Keys         = std::vector<Symbol>;
+  using MemberValues = std::vector<ValueP>;
+  using Numbers      = std::vector<double>;
+  using ShapeCache   = std::vector<Shape *>;
+
+  static constexpr size_t s_symbolCacheSize = 64;
+
+  using SymbolCache = std::array<Symbol, s_symbolCacheSize>;
+
+  CJson*      json_   { nullptr };
+  Arena*      arena_  { nullptr };
+  Value*      target_ { nullptr };
+  ValueP      root_;
+  Stack       stack_;
+
+  const char* viewBegin_ { nullptr };
+  const char* viewEnd_   { nullptr };
+
+  Symbols*    symbols_ { nullptr };
+  SymbolCache symbolCache_;
+  Symbol      key_;
+  bool        incremental_ { false };
+  bool        rawNumbers_  { false };
+
+  // keys and values of open objects and arrays
+  Keys         keys_;
+  MemberValues values_;
+  Numbers      numbers_;
+  ShapeCache   shapeCache_;
+};
+
+#endif
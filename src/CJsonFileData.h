@@ -0,0 +1,128 @@
+#ifndef CJsonFileData_H
+#define CJsonFileData_H
+
+#include <string>
+#include <algorithm>
+#include <cerrno>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// file contents, memory mapped for regular files or read into a buffer for
+// stdin, pipes and devices (or when mapping is disabled)
+class CJsonFileData {
+ public:
+  CJsonFileData() { }
+
+ ~CJsonFileData() {
+    if (map_)
+      munmap(map_, mapLen_);
+  }
+
+  CJsonFileData(const CJsonFileData &) = delete;
+  CJsonFileData &operator=(const CJsonFileData &) = delete;
+
+  const char *data() const { return data_; }
+  size_t      size() const { return len_; }
+
+  // use copy of character data
+  void setData(const char *data, size_t len) {
+    buffer_.assign(data, len);
+
+    data_ = buffer_.data();
+    len_  = len;
+  }
+
+  bool open(const std::string &filename, bool mapFile) {
+    int fd = 0;
+
+    if (filename != "-") {
+      fd = ::open(filename.c_str(), O_RDONLY);
+
+      if (fd < 0)
+        return false;
+    }
+
+    struct stat st;
+
+    bool isReg = (fstat(fd, &st) == 0 && S_ISREG(st.st_mode));
+
+    bool rc;
+
+    if (isReg && mapFile && st.st_size > 0)
+      rc = mapFd(fd, size_t(st.st_size));
+    else
+      rc = readFd(fd, isReg ? size_t(st.st_size) : 0);
+
+    if (fd != 0)
+      ::close(fd);
+
+    return rc;
+  }
+
+ private:
+  bool mapFd(int fd, size_t len) {
+    void *p = mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    if (p == MAP_FAILED)
+      return readFd(fd, len);
+
+    // parse is a single forward pass over the data (advice values are not
+    // flags so each is given separately)
+    (void) madvise(p, len, MADV_SEQUENTIAL);
+    (void) madvise(p, len, MADV_WILLNEED);
+
+    map_    = p;
+    mapLen_ = len;
+    data_   = static_cast<const char *>(p);
+    len_    = len;
+
+    return true;
+  }
+
+  bool readFd(int fd, size_t sizeHint) {
+    (void) posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    // read whole input in large blocks (size known for regular files)
+    size_t blockSize = std::max(sizeHint + 1, size_t(1 << 16));
+
+    size_t len = 0;
+
+    while (true) {
+      if (buffer_.size() < len + blockSize)
+        buffer_.resize(len + blockSize);
+
+      ssize_t n = ::read(fd, &buffer_[len], buffer_.size() - len);
+
+      if (n < 0) {
+        if (errno == EINTR)
+          continue;
+
+        return false;
+      }
+
+      if (n == 0)
+        break;
+
+      len += size_t(n);
+    }
+
+    buffer_.resize(len);
+
+    data_ = buffer_.data();
+    len_  = len;
+
+    return true;
+  }
+
+ private:
+  std::string buffer_;
+  void*       map_    { nullptr };
+  size_t      mapLen_ { 0 };
+  const char* data_   { "" };
+  size_t      len_    { 0 };
+};
+
+#endif
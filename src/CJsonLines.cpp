@@ -0,0 +1,351 @@
+#include <CJson.h>
+#include <CJsonFileData.h>
+#include <CJsonScan.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+// single line record
+struct Record {
+  const char *data { nullptr };
+  size_t      len  { 0 };
+  size_t      line { 0 };
+};
+
+using Records = std::vector<Record>;
+
+// range of records parsed by one worker task (into its own arena)
+struct Batch {
+  size_t        begin { 0 };
+  size_t        end   { 0 };
+  CJson::Arena* arena { nullptr };
+  CJson::Values values;
+  size_t        error { 0 };     // index of bad record (if not ok)
+  bool          ok    { true };
+  bool          done  { false };
+};
+
+using Batches = std::vector<Batch>;
+
+// target number of bytes for each batch
+const size_t s_batchBytes = 256*1024;
+
+// split data into non-blank lines
+void
+splitLines(const char *data, size_t len, Records &records)
+{
+  const char *p = data;
+  const char *e = data + len;
+
+  size_t line = 1;
+
+  while (p < e) {
+    const char *p1 = static_cast<const char *>(memchr(p, '\n', size_t(e - p)));
+    if (! p1) p1 = e;
+
+    if (CJsonScan::skipSpace(p, p1) != p1) {
+      Record record;
+
+      record.data = p;
+      record.len  = size_t(p1 - p);
+      record.line = line;
+
+      records.push_back(record);
+    }
+
+    p = p1 + 1;
+
+    ++line;
+  }
+}
+
+}
+
+//------
+
+bool
+CJson::
+loadLinesFile(const std::string &filename, Values &values)
+{
+  return processLinesFile(filename, [&](size_t, const ValueP &value) {
+    values.push_back(value);
+    return true;
+  }, /*keepValues*/true);
+}
+
+bool
+CJson::
+loadLinesData(const char *data, size_t len, Values &values)
+{
+  return processLinesData(data, len, [&](size_t, const ValueP &value) {
+    values.push_back(value);
+    return true;
+  }, /*keepValues*/true);
+}
+
+bool
+CJson::
+processLinesFile(const std::string &filename, const LineProc &proc)
+{
+  return processLinesFile(filename, proc, /*keepValues*/false);
+}
+
+bool
+CJson::
+processLinesData(const char *data, size_t len, const LineProc &proc)
+{
+  return processLinesData(data, len, proc, /*keepValues*/false);
+}
+
+bool
+CJson::
+processLinesFile(const std::string &filename, const LineProc &proc, bool keepValues)
+{
+  releaseValues();
+
+  auto fileData = std::make_shared<CJsonFileData>();
+
+  if (! fileData->open(filename, isMapFile())) {
+    if (! isQuiet())
+      std::cerr << "Failed to open file " << filename << "\n";
+    return false;
+  }
+
+  // lazy values, zero copy strings and raw numbers keep the file data
+  if (isKeepData()) {
+    keepData(fileData);
+
+    return processLines(fileData->data(), fileData->size(), proc, fileData, keepValues);
+  }
+
+  return processLines(fileData->data(), fileData->size(), proc, DataP(), keepValues);
+}
+
+bool
+CJson::
+processLinesData(const char *data, size_t len, const LineProc &proc, bool keepValues)
+{
+  releaseValues();
+
+  // lazy values, zero copy strings and raw numbers need a copy of the data
+  if (isKeepData()) {
+    auto keepData1 = std::make_shared<CJsonFileData>();
+
+    keepData1->setData(data, len);
+
+    keepData(keepData1);
+
+    return processLines(keepData1->data(), keepData1->size(), proc, keepData1, keepValues);
+  }
+
+  return processLines(data, len, proc, DataP(), keepValues);
+}
+
+bool
+CJson::
+processLines(const char *data, size_t len, const LineProc &proc, const DataP &keepData,
+             bool keepValues)
+{
+  Records records;
+
+  splitLines(data, len, records);
+
+  //---
+
+  // group records into batches of about s_batchBytes
+  Batches batches;
+
+  size_t nr = records.size();
+
+  for (size_t i = 0; i < nr; ) {
+    Batch batch;
+
+    batch.begin = i;
+
+    size_t bytes = 0;
+
+    while (i < nr && (i == batch.begin || bytes < s_batchBytes))
+      bytes += records[i++].len;
+
+    batch.end = i;
+
+    batches.push_back(std::move(batch));
+  }
+
+  size_t nb = batches.size();
+
+  //---
+
+  // parse records of batch (quietly, bad record is reparsed for message)
+  auto parseBatch = [&](Batch &batch) {
+    batch.arena = newArena();
+
+    batch.values.reserve(batch.end - batch.begin);
+
+    for (size_t i = batch.begin; i < batch.end; ++i) {
+      const auto &record = records[i];
+
+      ValueP value;
+
+      if (! loadRecord(record.data, record.len, value, /*quiet*/true, keepData, batch.arena)) {
+        batch.ok    = false;
+        batch.error = i;
+        break;
+      }
+
+      batch.values.push_back(value);
+    }
+  };
+
+  // deliver batch values in order (values, and results created for them, are
+  // released after the batch unless kept)
+  auto processBatch = [&](Batch &batch) {
+    bool rc = true;
+
+    for (size_t i = 0; i < batch.values.size(); ++i) {
+      if (! proc(records[batch.begin + i].line, batch.values[i])) {
+        rc = false;
+        break;
+      }
+    }
+
+    batch.values.clear();
+
+    if (! keepValues) {
+      releaseResults();
+
+      releaseArena(batch.arena);
+    }
+
+    if (! rc)
+      return false;
+
+    if (! batch.ok) {
+      const auto &record = records[batch.error];
+
+      if (! isQuiet()) {
+        ValueP value;
+
+        (void) loadRecord(record.data, record.len, value, /*quiet*/false);
+
+        std::cerr << "Error: Invalid record at line " << record.line << "\n";
+      }
+
+      return false;
+    }
+
+    return true;
+  };
+
+  //---
+
+  uint numThreads = std::min(numWorkerThreads(), uint(nb));
+
+  if (numThreads <= 1) {
+    for (auto &batch : batches) {
+      parseBatch(batch);
+
+      if (! processBatch(batch))
+        return false;
+    }
+
+    return true;
+  }
+
+  //---
+
+  // workers parse batches at most window ahead of the (in order) consumer
+  size_t window = 4*numThreads;
+
+  std::mutex              mutex;
+  std::condition_variable parsedCond, consumedCond;
+
+  size_t            nextBatch = 0;
+  size_t            consumed  = 0;
+  std::atomic<bool> stop { false };
+
+  auto worker = [&]() {
+    while (true) {
+      size_t ib;
+
+      {
+      std::unique_lock<std::mutex> lock(mutex);
+
+      consumedCond.wait(lock, [&]() {
+        return stop || nextBatch >= nb || nextBatch < consumed + window; });
+
+      if (stop || nextBatch >= nb)
+        return;
+
+      ib = nextBatch++;
+      }
+
+      parseBatch(batches[ib]);
+
+      {
+      std::unique_lock<std::mutex> lock(mutex);
+
+      batches[ib].done = true;
+      }
+
+      parsedCond.notify_all();
+    }
+  };
+
+  std::vector<std::thread> threads;
+
+  for (uint i = 0; i < numThreads; ++i)
+    threads.emplace_back(worker);
+
+  bool rc = true;
+
+  for (size_t ib = 0; ib < nb; ++ib) {
+    {
+    std::unique_lock<std::mutex> lock(mutex);
+
+    parsedCond.wait(lock, [&]() { return batches[ib].done; });
+    }
+
+    if (! processBatch(batches[ib])) {
+      rc = false;
+      break;
+    }
+
+    {
+    std::unique_lock<std::mutex> lock(mutex);
+
+    ++consumed;
+    }
+
+    consumedCond.notify_all();
+  }
+
+  {
+  std::unique_lock<std::mutex> lock(mutex);
+
+  stop = true;
+  }
+
+  consumedCond.notify_all();
+
+  for (auto &thread : threads)
+    thread.join();
+
+  return rc;
+}
+
+//------
+
+uint
+CJson::
+numWorkerThreads() const
+{
+  if (numThreads() > 0)
+    return uint(numThreads());
+
+  return std::max(std::thread::hardware_concurrency(), 1U);
+}
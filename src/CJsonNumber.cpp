@@ -0,0 +1,256 @@
+#include <CJsonNumber.h>
+#include <charconv>
+#include <cmath>
+#include <string>
+#include <cstdlib>
+#include <cstring>
+#include <clocale>
+#include <locale.h>
+
+namespace {
+
+// exactly representable powers of ten
+const double s_pow10[] = {
+  1e0 , 1e1 , 1e2 , 1e3 , 1e4 , 1e5 , 1e6 , 1e7 , 1e8 , 1e9 , 1e10, 1e11,
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+const int      s_maxPow10    = 22;
+const uint64_t s_maxMantissa = uint64_t(1) << 53;
+
+const uint64_t s_intPow10[] = {
+  1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL,
+  100000000ULL, 1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL,
+  10000000000000ULL, 100000000000000ULL, 1000000000000000ULL
+};
+
+// accumulate decimal of (valid) number text
+void
+scanDecimal(const char *str, size_t len, CJsonNumber::Decimal &decimal)
+{
+  const char *p = str;
+  const char *e = str + len;
+
+  if (p < e && *p == '-') {
+    decimal.negative = true;
+
+    ++p;
+  }
+
+  while (p < e && *p >= '0' && *p <= '9')
+    decimal.addDigit(*p++ - '0', false);
+
+  if (p < e && *p == '.') {
+    decimal.addPoint();
+
+    ++p;
+
+    while (p < e && *p >= '0' && *p <= '9')
+      decimal.addDigit(*p++ - '0', true);
+  }
+
+  if (p < e && (*p == 'e' || *p == 'E')) {
+    ++p;
+
+    bool negExp = false;
+
+    if (p < e && (*p == '+' || *p == '-'))
+      negExp = (*p++ == '-');
+
+    int exp = 0;
+
+    while (p < e && *p >= '0' && *p <= '9') {
+      if (exp < CJsonNumber::MAX_EXPONENT)
+        exp = exp*10 + (*p - '0');
+
+      ++p;
+    }
+
+    decimal.addExponent(negExp ? -exp : exp);
+  }
+}
+
+// strtod independent of current (application) locale
+double
+strtodC(const char *str, char **end)
+{
+  static locale_t s_cLocale = newlocale(LC_ALL_MASK, "C", locale_t(0));
+
+  if (s_cLocale)
+    return strtod_l(str, end, s_cLocale);
+
+  return strtod(str, end);
+}
+
+}
+
+//------
+
+double
+CJsonNumber::
+toDouble(const Decimal &decimal, const char *str, size_t len)
+{
+  if (decimal.truncated)
+    return textToDouble(str, len);
+
+  uint64_t m = decimal.mantissa;
+  int      e = decimal.exponent;
+
+  double r;
+
+  if      (m == 0)
+    r = 0.0;
+  // integer (conversion is correctly rounded)
+  else if (e == 0)
+    r = double(m);
+  // exact mantissa and power of ten so single rounding
+  else if (m <= s_maxMantissa && e < 0 && e >= -s_maxPow10)
+    r = double(m)/s_pow10[-e];
+  else if (m <= s_maxMantissa && e > 0 && e <= s_maxPow10)
+    r = double(m)*s_pow10[e];
+  // move extra power into mantissa if it stays exact
+  else if (m <= s_maxMantissa && e > s_maxPow10 && e <= s_maxPow10 + 15 &&
+           m <= s_maxMantissa/s_intPow10[e - s_maxPow10])
+    r = double(m*s_intPow10[e - s_maxPow10])*s_pow10[s_maxPow10];
+  else
+    return textToDouble(str, len);
+
+  return (decimal.negative ? -r : r);
+}
+
+double
+CJsonNumber::
+textToDouble(const char *str, size_t len)
+{
+#ifdef __cpp_lib_to_chars
+  double r = 0.0;
+
+  auto rc = std::from_chars(str, str + len, r);
+
+  if (rc.ec == std::errc() && rc.ptr == str + len)
+    return r;
+#endif
+
+  // out of range (or unsupported) so use strtod on terminated copy
+  char buffer[64];
+
+  if (len < sizeof(buffer)) {
+    memcpy(buffer, str, len);
+
+    buffer[len] = '\0';
+
+    return strtodC(buffer, nullptr);
+  }
+  else {
+    std::string str1(str, len);
+
+    return strtodC(str1.c_str(), nullptr);
+  }
+}
+
+double
+CJsonNumber::
+parseDouble(const char *str, size_t len)
+{
+  Decimal decimal;
+
+  scanDecimal(str, len, decimal);
+
+  return toDouble(decimal, str, len);
+}
+
+CJsonNumber::IntegerType
+CJsonNumber::
+toInteger(const Decimal &decimal, const char *str, size_t len, int64_t &i, uint64_t &u)
+{
+  // integers are plain digits (1.0 and 1e0 are reals)
+  if (! decimal.integral)
+    return IntegerType::NONE;
+
+  // positive integer with one more digit than mantissa may fit in uint64
+  if (decimal.exponent == 1 && decimal.numDigits == MAX_DIGITS && ! decimal.negative) {
+    auto res = std::from_chars(str, str + len, u);
+
+    if (res.ec == std::errc() && res.ptr == str + len)
+      return IntegerType::UINT64;
+
+    return IntegerType::NONE;
+  }
+
+  // all digits must be in mantissa with no scaling
+  if (decimal.exponent != 0 || decimal.truncated)
+    return IntegerType::NONE;
+
+  // mantissa has at most MAX_DIGITS digits so fits in uint64
+  uint64_t m = decimal.mantissa;
+
+  if (decimal.negative) {
+    if (m == 0 || m > uint64_t(INT64_MAX) + 1)
+      return IntegerType::NONE;
+
+    i = (m == uint64_t(INT64_MAX) + 1 ? INT64_MIN : -int64_t(m));
+
+    return IntegerType::INT64;
+  }
+
+  if (m > uint64_t(INT64_MAX)) {
+    u = m;
+
+    return IntegerType::UINT64;
+  }
+
+  i = int64_t(m);
+
+  return IntegerType::INT64;
+}
+
+CJsonNumber::IntegerType
+CJsonNumber::
+parseInteger(const char *str, size_t len, int64_t &i, uint64_t &u)
+{
+  Decimal decimal;
+
+  scanDecimal(str, len, decimal);
+
+  return toInteger(decimal, str, len, i, u);
+}
+
+//---
+
+bool
+CJsonNumber::
+isIntegral(double r, int64_t &i)
+{
+  if (! (r >= -double(MAX_EXACT_INTEGER) && r <= double(MAX_EXACT_INTEGER)))
+    return false;
+
+  i = int64_t(r);
+
+  if (double(i) != r || (i == 0 && std::signbit(r)))
+    return false;
+
+  return true;
+}
+
+char *
+CJsonNumber::
+format(char *buffer, double r)
+{
+  char *end = buffer + MAX_FORMAT_LEN;
+
+  int64_t i;
+
+  if (isIntegral(r, i))
+    return std::to_chars(buffer, end, i).ptr;
+
+  return std::to_chars(buffer, end, r).ptr;
+}
+
+std::string
+CJsonNumber::
+toString(double r)
+{
+  char buffer[MAX_FORMAT_LEN];
+
+  return std::string(buffer, format(buffer, r));
+}
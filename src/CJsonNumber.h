@@ -0,0 +1,113 @@
+#ifndef CJsonNumber_H
+#define CJsonNumber_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Decimal to double conversion for the JSON parser.
+//
+// The parser accumulates the significant digits and decimal exponent of a
+// number while scanning it so most numbers convert without touching the
+// text again:
+//  . integers (up to 19 digits) convert directly
+//  . mantissas up to 2^53 with small exponents use exact double arithmetic
+//    (Clinger's fast path)
+//  . anything else uses std::from_chars on the input text (correctly
+//    rounded, locale independent) and the C locale strtod only for out of
+//    range results.
+//
+// Exact integers (no fraction or exponent) in the int64 or uint64 range are
+// kept as integers.
+namespace CJsonNumber {
+  enum { MAX_DIGITS = 19 };
+
+  struct Decimal {
+    bool     negative  { false };
+    uint64_t mantissa  { 0 };     // first MAX_DIGITS significant digits
+    int      exponent  { 0 };     // decimal exponent for mantissa
+    bool     truncated { false }; // non-zero digits dropped from mantissa
+    int      numDigits { 0 };     // significant digits in mantissa
+    bool     integral  { true };  // text has no fraction or exponent part
+
+    // add next digit of integer or fraction part
+    void addDigit(int d, bool fraction) {
+      if (numDigits < MAX_DIGITS) {
+        mantissa = mantissa*10 + uint64_t(d);
+
+        if (mantissa)
+          ++numDigits;
+
+        if (fraction)
+          --exponent;
+      }
+      else {
+        if (d)
+          truncated = true;
+
+        if (! fraction)
+          ++exponent;
+      }
+    }
+
+    // decimal point seen (number is real even with no fraction digits)
+    void addPoint() {
+      integral = false;
+    }
+
+    // add (value of) exponent part
+    void addExponent(int e) {
+      exponent += e;
+
+      integral = false;
+    }
+  };
+
+  // large exponents are out of range anyway (text conversion handles them)
+  enum { MAX_EXPONENT = 100000 };
+
+  // convert decimal (scanned from number text [str, str + len)) to double
+  double toDouble(const Decimal &decimal, const char *str, size_t len);
+
+  // convert number text to double (slow path)
+  double textToDouble(const char *str, size_t len);
+
+  // convert (valid) number text to double (scans digits then uses toDouble)
+  double parseDouble(const char *str, size_t len);
+
+  //---
+
+  enum class IntegerType {
+    NONE,  // not an exact integer (or out of range)
+    INT64, // integer in int64 range (i)
+    UINT64 // positive integer only in uint64 range (u)
+  };
+
+  // get integer value of decimal scanned from number text [str, str + len)
+  // (-0 is not an integer)
+  IntegerType toInteger(const Decimal &decimal, const char *str, size_t len,
+                        int64_t &i, uint64_t &u);
+
+  // get integer value of (valid) number text
+  IntegerType parseInteger(const char *str, size_t len, int64_t &i, uint64_t &u);
+
+  //---
+
+  // largest integer magnitude held exactly by a double
+  constexpr int64_t MAX_EXACT_INTEGER = int64_t(1) << 53;
+
+  // is double an integer exactly held in int64 (-0 is not an integer)
+  bool isIntegral(double r, int64_t &i);
+
+  // max length of formatted double
+  constexpr size_t MAX_FORMAT_LEN = 32;
+
+  // format double into buffer (at least MAX_FORMAT_LEN chars) and return end.
+  // Uses the shortest text which reads back as the same double and exact
+  // integers are formatted as integers (no fraction or exponent).
+  char *format(char *buffer, double r);
+
+  std::string toString(double r);
+}
+
+#endif
@@ -0,0 +1,708 @@
+#include <CJson.h>
+#include <CJsonDomBuilder.h>
+#include <CJsonNumber.h>
+#include <CJsonScan.h>
+#include <CUtf8.h>
+#include <cstring>
+
+namespace {
+  inline int hexCharValue(char c) {
+    if (isdigit(c)) return (c - '0');
+
+    return (tolower(c) - 'a' + 10);
+  }
+
+  inline bool isDigitChar(char c) {
+    return (static_cast<unsigned char>(c - '0') <= 9);
+  }
+}
+
+//------
+
+// number being read (text kept for slow path conversion)
+struct CJson::PushParser::NumberData {
+  NumberState          state    { NumberState::START };
+  CJsonNumber::Decimal decimal;
+  int                  exponent { 0 };
+  bool                 expNeg   { false };
+  std::string          text;
+
+  void reset() {
+    state    = NumberState::START;
+    decimal  = CJsonNumber::Decimal();
+    exponent = 0;
+    expNeg   = false;
+
+    text.clear();
+  }
+};
+
+//------
+
+CJson::PushParser::
+PushParser(CJson *json) :
+ json_(json), number_(std::make_unique<NumberData>())
+{
+  json->releaseValues();
+
+  auto builder = std::make_unique<DomBuilder>(json, json->mainArena());
+
+  // root() shows values built so far
+  builder->setIncremental(true);
+
+  builder_ = std::move(builder);
+  handler_ = builder_.get();
+}
+
+CJson::PushParser::
+PushParser(CJson *json, Handler &handler) :
+ json_(json), handler_(&handler), number_(std::make_unique<NumberData>())
+{
+}
+
+CJson::PushParser::
+~PushParser()
+{
+}
+
+CJson::ValueP
+CJson::PushParser::
+root() const
+{
+  if (! builder_)
+    return ValueP();
+
+  return static_cast<DomBuilder *>(builder_.get())->root();
+}
+
+bool
+CJson::PushParser::
+feed(const char *data, size_t len)
+{
+  if (state_ == State::ERROR || state_ == State::DONE)
+    return false;
+
+  if (json_->maxSize() > 0 && chunkPos_ + len > json_->maxSize()) {
+    (void) error(json_->maxSize(), "Document too large");
+    return false;
+  }
+
+  chunk_ = data;
+
+  const char *p = data;
+  const char *e = data + len;
+
+  while (p && p < e)
+    p = feedChars(p, e);
+
+  chunkPos_ += len;
+
+  chunk_ = nullptr;
+
+  return (state_ != State::ERROR);
+}
+
+bool
+CJson::PushParser::
+finish()
+{
+  if (state_ == State::ERROR)
+    return false;
+
+  if (state_ == State::DONE)
+    return true;
+
+  // end of input terminates number (unless incomplete)
+  if (state_ == State::NUMBER) {
+    auto numberState = number_->state;
+
+    if (numberState == NumberState::SIGN || numberState == NumberState::EXPONENT ||
+        numberState == NumberState::EXPONENT_SIGN ||
+        (numberState == NumberState::POINT && json_->isStrict())) {
+      error(chunkPos_, "Invalid number char");
+      return false;
+    }
+
+    if (! endNumber())
+      return false;
+  }
+
+  // remaining errors match those of the (whole document) parser at end of data
+  const char *msg = nullptr;
+
+  switch (state_) {
+    case State::END:
+      state_ = State::DONE;
+      return true;
+    case State::VALUE:
+      msg = "Invalid char for value";
+      break;
+    case State::OBJECT_START:
+    case State::OBJECT_KEY:
+      if      (space_)
+        msg = (json_->isAllowSingleQuote() ?
+                "Missing open quote for string" : "Missing double quote for string");
+      else if (state_ == State::OBJECT_START)
+        msg = "Missing close brace for object";
+      else
+        msg = "Missing data after comma for object";
+      break;
+    case State::OBJECT_COLON:
+      msg = "Missing color separator for object";
+      break;
+    case State::OBJECT_NEXT:
+      msg = "Missing close brace for object";
+      break;
+    case State::ARRAY_START:
+    case State::ARRAY_VALUE:
+      if      (space_)
+        msg = "Invalid char for value";
+      else if (state_ == State::ARRAY_START)
+        msg = "Missing close square bracket for array";
+      else
+        msg = "Missing value after command for array";
+      break;
+    case State::ARRAY_NEXT:
+      msg = "Missing close square bracket for array";
+      break;
+    case State::STRING:
+    case State::STRING_ESCAPE:
+      msg = "Missing close quote for string";
+      break;
+    case State::STRING_UNICODE:
+      msg = "Bad hex digit";
+      break;
+    case State::LITERAL:
+      error(literalPos_, "Invalid char for value");
+      return false;
+    default:
+      msg = "Invalid char for value";
+      break;
+  }
+
+  error(chunkPos_, msg);
+
+  return false;
+}
+
+// process chars in current state (returns next char or null on error)
+const char *
+CJson::PushParser::
+feedChars(const char *p, const char *e)
+{
+  switch (state_) {
+    case State::VALUE: {
+      p = CJsonScan::skipSpace(p, e);
+      if (p == e) return p;
+
+      return startValue(p, e);
+    }
+    case State::OBJECT_START:
+    case State::OBJECT_KEY: {
+      const char *p1 = CJsonScan::skipSpace(p, e);
+      if (p1 != p) space_ = true;
+      if (p1 == e) return p1;
+
+      if (*p1 == '}') {
+        if (state_ == State::OBJECT_KEY)
+          return error(charPos(p1), "Missing data after comma for object");
+
+        return (endObject() ? p1 + 1 : nullptr);
+      }
+
+      return startString(p1, e, /*isKey*/true);
+    }
+    case State::OBJECT_COLON: {
+      p = CJsonScan::skipSpace(p, e);
+      if (p == e) return p;
+
+      if (*p != ':')
+        return error(charPos(p), "Missing color separator for object");
+
+      state_ = State::VALUE;
+
+      return p + 1;
+    }
+    case State::OBJECT_NEXT: {
+      p = CJsonScan::skipSpace(p, e);
+      if (p == e) return p;
+
+      if (*p == ',') {
+        state_ = State::OBJECT_KEY;
+        space_ = false;
+
+        return p + 1;
+      }
+
+      if (*p != '}')
+        return error(charPos(p), "Missing close brace for object");
+
+      return (endObject() ? p + 1 : nullptr);
+    }
+    case State::ARRAY_START:
+    case State::ARRAY_VALUE: {
+      const char *p1 = CJsonScan::skipSpace(p, e);
+      if (p1 != p) space_ = true;
+      if (p1 == e) return p1;
+
+      if (*p1 == ']') {
+        if (state_ == State::ARRAY_VALUE)
+          return error(charPos(p1), "Missing value after command for array");
+
+        return (endArray() ? p1 + 1 : nullptr);
+      }
+
+      return startValue(p1, e);
+    }
+    case State::ARRAY_NEXT: {
+      p = CJsonScan::skipSpace(p, e);
+      if (p == e) return p;
+
+      if (*p == ',') {
+        state_ = State::ARRAY_VALUE;
+        space_ = false;
+
+        return p + 1;
+      }
+
+      if (*p != ']')
+        return error(charPos(p), "Missing close square bracket for array");
+
+      return (endArray() ? p + 1 : nullptr);
+    }
+    case State::STRING:
+      return readString(p, e);
+    case State::STRING_ESCAPE:
+      return readEscape(p, e);
+    case State::STRING_UNICODE:
+      return readUnicode(p, e);
+    case State::NUMBER:
+      return readNumber(p, e);
+    case State::LITERAL:
+      return readLiteral(p, e);
+    case State::END: {
+      p = CJsonScan::skipSpace(p, e);
+      if (p == e) return p;
+
+      return error(charPos(p), "Extra characters for string");
+    }
+    default:
+      return nullptr;
+  }
+}
+
+// start value at first char
+const char *
+CJson::PushParser::
+startValue(const char *p, const char *e)
+{
+  char c = *p;
+
+  if      (c == '\"' || (c == '\'' && json_->isAllowSingleQuote())) {
+    return startString(p, e, /*isKey*/false);
+  }
+  else if (c == '-' || isDigitChar(c)) {
+    number_->reset();
+
+    state_ = State::NUMBER;
+
+    return p;
+  }
+  else if (c == '{' || c == '[') {
+    if (json_->maxDepth() > 0 && stack_.size() >= size_t(json_->maxDepth()))
+      return error(charPos(p), "Maximum depth exceeded");
+
+    if (c == '{')
+      return (startObject() ? p + 1 : nullptr);
+
+    return (startArray() ? p + 1 : nullptr);
+  }
+  else if (c == 't' || c == 'f' || c == 'n') {
+    literal_    = (c == 't' ? "true" : c == 'f' ? "false" : "null");
+    literalLen_ = 1;
+    literalPos_ = charPos(p);
+
+    state_ = State::LITERAL;
+
+    return p + 1;
+  }
+  else
+    return error(charPos(p), "Invalid char for value");
+}
+
+// start string (key or value) at open quote
+const char *
+CJson::PushParser::
+startString(const char *p, const char *e, bool isKey)
+{
+  if (isKey) {
+    if (json_->isAllowSingleQuote()) {
+      if (*p != '\"' && *p != '\'')
+        return error(charPos(p), "Missing open quote for string");
+    }
+    else {
+      if (*p != '\"')
+        return error(charPos(p), "Missing double quote for string");
+    }
+  }
+
+  quote_ = *p;
+  isKey_ = isKey;
+
+  buffer_.clear();
+
+  ++p;
+
+  // string in this chunk with no escapes so use chars directly
+  const char *p1 = CJsonScan::findQuoteOrEscape(p, e, quote_);
+
+  if (p1 < e && *p1 == quote_)
+    return (endString(std::string_view(p, size_t(p1 - p))) ? p1 + 1 : nullptr);
+
+  buffer_.append(p, size_t(p1 - p));
+
+  state_ = State::STRING;
+
+  if (p1 < e) {
+    state_ = State::STRING_ESCAPE;
+
+    return p1 + 1;
+  }
+
+  return p1;
+}
+
+const char *
+CJson::PushParser::
+readString(const char *p, const char *e)
+{
+  const char *p1 = CJsonScan::findQuoteOrEscape(p, e, quote_);
+
+  buffer_.append(p, size_t(p1 - p));
+
+  if (p1 == e)
+    return p1;
+
+  if (*p1 == quote_)
+    return (endString(buffer_) ? p1 + 1 : nullptr);
+
+  state_ = State::STRING_ESCAPE;
+
+  return p1 + 1;
+}
+
+// char after backslash
+const char *
+CJson::PushParser::
+readEscape(const char *p, const char *)
+{
+  char c = *p;
+
+  state_ = State::STRING;
+
+  switch (c) {
+    case '\"': buffer_ += '\"'; break;
+    case '\\': buffer_ += '\\'; break;
+    case '/' : buffer_ += '/' ; break;
+    case 'b' : buffer_ += '\b'; break;
+    case 'f' : buffer_ += '\f'; break;
+    case 'n' : buffer_ += '\n'; break;
+    case 'r' : buffer_ += '\r'; break;
+    case 't' : buffer_ += '\t'; break;
+    case 'u' : {
+      unicodeLen_   = 0;
+      unicodeValue_ = 0;
+
+      state_ = State::STRING_UNICODE;
+
+      break;
+    }
+    default: {
+      if (json_->isStrict())
+        return error(charPos(p + 1), "Bad char in string");
+
+      buffer_ += c;
+
+      break;
+    }
+  }
+
+  return p + 1;
+}
+
+// 4 hexadecimal digits
+const char *
+CJson::PushParser::
+readUnicode(const char *p, const char *e)
+{
+  while (p < e && unicodeLen_ < 4) {
+    if (! isxdigit(*p))
+      return error(charPos(p), "Bad hex digit");
+
+    unicodeValue_ = (unicodeValue_ << 4) | (hexCharValue(*p) & 0xF);
+
+    ++unicodeLen_;
+    ++p;
+  }
+
+  if (unicodeLen_ == 4) {
+    CUtf8::append(buffer_, ulong(unicodeValue_));
+
+    state_ = State::STRING;
+  }
+
+  return p;
+}
+
+const char *
+CJson::PushParser::
+readNumber(const char *p, const char *e)
+{
+  auto &number = *number_;
+
+  const char *p1 = p;
+
+  bool done = false;
+
+  while (p < e && ! done) {
+    char c     = *p;
+    bool digit = isDigitChar(c);
+
+    switch (number.state) {
+      case NumberState::START:
+        if (c == '-') {
+          number.decimal.negative = true;
+          number.state            = NumberState::SIGN;
+          break;
+        }
+
+        // fall through
+      case NumberState::SIGN:
+        if      (c == '0')
+          number.state = NumberState::ZERO;
+        else if (digit) {
+          number.decimal.addDigit(c - '0', false);
+          number.state = NumberState::INTEGER;
+        }
+        else
+          return error(charPos(p), "Invalid number char");
+        break;
+      case NumberState::ZERO:
+      case NumberState::INTEGER:
+        if      (digit && number.state == NumberState::INTEGER)
+          number.decimal.addDigit(c - '0', false);
+        else if (c == '.') {
+          number.decimal.addPoint();
+          number.state = NumberState::POINT;
+        }
+        else if (c == 'e' || c == 'E')
+          number.state = NumberState::EXPONENT;
+        else
+          done = true;
+        break;
+      case NumberState::POINT:
+      case NumberState::FRACTION:
+        if      (digit) {
+          number.decimal.addDigit(c - '0', true);
+          number.state = NumberState::FRACTION;
+        }
+        else if (number.state == NumberState::POINT && json_->isStrict())
+          return error(charPos(p), "Invalid number char");
+        else if (c == 'e' || c == 'E')
+          number.state = NumberState::EXPONENT;
+        else
+          done = true;
+        break;
+      case NumberState::EXPONENT:
+        if (c == '+' || c == '-') {
+          number.expNeg = (c == '-');
+          number.state  = NumberState::EXPONENT_SIGN;
+          break;
+        }
+
+        // fall through
+      case NumberState::EXPONENT_SIGN:
+      case NumberState::EXPONENT_DIGITS:
+        if      (digit) {
+          if (number.exponent < CJsonNumber::MAX_EXPONENT)
+            number.exponent = number.exponent*10 + (c - '0');
+
+          number.state = NumberState::EXPONENT_DIGITS;
+        }
+        else if (number.state != NumberState::EXPONENT_DIGITS)
+          return error(charPos(p), "Invalid number char");
+        else
+          done = true;
+        break;
+    }
+
+    if (! done)
+      ++p;
+  }
+
+  number.text.append(p1, size_t(p - p1));
+
+  if (done && ! endNumber())
+    return nullptr;
+
+  return p;
+}
+
+const char *
+CJson::PushParser::
+readLiteral(const char *p, const char *e)
+{
+  int len = int(strlen(literal_));
+
+  while (p < e && literalLen_ < len) {
+    if (*p != literal_[literalLen_])
+      return error(literalPos_, "Invalid char for value");
+
+    ++literalLen_;
+    ++p;
+  }
+
+  if (literalLen_ < len)
+    return p;
+
+  bool rc;
+
+  if      (literal_[0] == 't')
+    rc = handler_->boolean(true);
+  else if (literal_[0] == 'f')
+    rc = handler_->boolean(false);
+  else
+    rc = handler_->null();
+
+  return (endValue(rc) ? p : nullptr);
+}
+
+//---
+
+bool
+CJson::PushParser::
+endString(std::string_view str)
+{
+  if (isKey_) {
+    if (! handler_->key(str))
+      return stop();
+
+    state_ = State::OBJECT_COLON;
+
+    return true;
+  }
+
+  return endValue(handler_->string(str));
+}
+
+bool
+CJson::PushParser::
+endNumber()
+{
+  auto &number = *number_;
+
+  if (number.state == NumberState::EXPONENT_DIGITS)
+    number.decimal.addExponent(number.expNeg ? -number.exponent : number.exponent);
+
+  // exact integers skip double conversion
+  int64_t  i;
+  uint64_t u;
+
+  switch (CJsonNumber::toInteger(number.decimal, number.text.c_str(), number.text.size(), i, u)) {
+    case CJsonNumber::IntegerType::INT64 : return endValue(handler_->integer(i));
+    case CJsonNumber::IntegerType::UINT64: return endValue(handler_->unsignedInteger(u));
+    default: break;
+  }
+
+  double r = CJsonNumber::toDouble(number.decimal, number.text.c_str(), number.text.size());
+
+  return endValue(handler_->number(r));
+}
+
+// value complete so continue with parent
+bool
+CJson::PushParser::
+endValue(bool rc)
+{
+  if (! rc)
+    return stop();
+
+  if      (stack_.empty())
+    state_ = State::END;
+  else if (stack_.back() == '{')
+    state_ = State::OBJECT_NEXT;
+  else
+    state_ = State::ARRAY_NEXT;
+
+  return true;
+}
+
+bool
+CJson::PushParser::
+startObject()
+{
+  stack_.push_back('{');
+
+  state_ = State::OBJECT_START;
+  space_ = false;
+
+  if (! handler_->startObject())
+    return stop();
+
+  return true;
+}
+
+bool
+CJson::PushParser::
+endObject()
+{
+  stack_.pop_back();
+
+  return endValue(handler_->endObject());
+}
+
+bool
+CJson::PushParser::
+startArray()
+{
+  stack_.push_back('[');
+
+  state_ = State::ARRAY_START;
+  space_ = false;
+
+  if (! handler_->startArray())
+    return stop();
+
+  return true;
+}
+
+bool
+CJson::PushParser::
+endArray()
+{
+  stack_.pop_back();
+
+  return endValue(handler_->endArray());
+}
+
+//---
+
+const char *
+CJson::PushParser::
+error(size_t pos, const char *msg)
+{
+  json_->errorMsg(pos, msg);
+
+  state_ = State::ERROR;
+
+  return nullptr;
+}
+
+bool
+CJson::PushParser::
+stop()
+{
+  state_ = State::ERROR;
+
+  return false;
+}
@@ -0,0 +1,356 @@
+#include <CJsonScan.h>
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define CJSON_SCAN_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+inline bool isSpaceChar(unsigned char c) {
+  return (c == ' ' || (c >= '\t' && c <= '\r'));
+}
+
+inline bool isStructuralChar(unsigned char c) {
+  return (c == '{' || c == '}' || c == '[' || c == ']' || c == ':' || c == ',');
+}
+
+inline int firstBit(uint64_t mask) {
+  return __builtin_ctzll(mask);
+}
+
+//---
+
+void
+classifyScalar(const char *p, char quote, CJsonScan::BlockMasks &masks)
+{
+  masks = CJsonScan::BlockMasks();
+
+  for (int i = 0; i < CJsonScan::BLOCK_SIZE; ++i) {
+    auto c   = static_cast<unsigned char>(p[i]);
+    auto bit = uint64_t(1) << i;
+
+    if      (c == static_cast<unsigned char>(quote)) masks.quote      |= bit;
+    else if (c == '\\'                             ) masks.backslash  |= bit;
+    else if (isStructuralChar(c)                   ) masks.structural |= bit;
+    else if (isSpaceChar(c)                        ) masks.space      |= bit;
+  }
+}
+
+#ifdef CJSON_SCAN_X86
+// masks for 16 bytes
+inline void
+classify16(__m128i v, __m128i q, uint32_t &quote, uint32_t &backslash,
+           uint32_t &structural, uint32_t &space)
+{
+  auto eq = [&](char c) { return _mm_cmpeq_epi8(v, _mm_set1_epi8(c)); };
+
+  quote     = uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(v, q)));
+  backslash = uint32_t(_mm_movemask_epi8(eq('\\')));
+
+  auto s1 = _mm_or_si128(_mm_or_si128(eq('{'), eq('}')), _mm_or_si128(eq('['), eq(']')));
+  auto s2 = _mm_or_si128(eq(':'), eq(','));
+
+  structural = uint32_t(_mm_movemask_epi8(_mm_or_si128(s1, s2)));
+
+  // '\t'..'\r' : (c - '\t') <= 4 unsigned
+  auto d  = _mm_sub_epi8(v, _mm_set1_epi8('\t'));
+  auto ws = _mm_cmpeq_epi8(_mm_min_epu8(d, _mm_set1_epi8(4)), d);
+
+  space = uint32_t(_mm_movemask_epi8(_mm_or_si128(ws, eq(' '))));
+}
+
+void
+classifySSE2(const char *p, char quote, CJsonScan::BlockMasks &masks)
+{
+  auto q = _mm_set1_epi8(quote);
+
+  masks = CJsonScan::BlockMasks();
+
+  for (int i = 0; i < 4; ++i) {
+    auto v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 16*i));
+
+    uint32_t quote1, backslash1, structural1, space1;
+
+    classify16(v, q, quote1, backslash1, structural1, space1);
+
+    masks.quote      |= uint64_t(quote1     ) << (16*i);
+    masks.backslash  |= uint64_t(backslash1 ) << (16*i);
+    masks.structural |= uint64_t(structural1) << (16*i);
+    masks.space      |= uint64_t(space1     ) << (16*i);
+  }
+}
+
+__attribute__((target("avx2")))
+inline uint64_t
+maskAVX2(__m256i v, char c)
+{
+  return uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(c))));
+}
+
+__attribute__((target("avx2")))
+void
+classifyAVX2(const char *p, char quote, CJsonScan::BlockMasks &masks)
+{
+  masks = CJsonScan::BlockMasks();
+
+  for (int i = 0; i < 2; ++i) {
+    auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + 32*i));
+
+    uint64_t structural = maskAVX2(v, '{') | maskAVX2(v, '}') | maskAVX2(v, '[') |
+                          maskAVX2(v, ']') | maskAVX2(v, ':') | maskAVX2(v, ',');
+
+    // '\t'..'\r' : (c - '\t') <= 4 unsigned
+    auto d  = _mm256_sub_epi8(v, _mm256_set1_epi8('\t'));
+    auto ws = _mm256_cmpeq_epi8(_mm256_min_epu8(d, _mm256_set1_epi8(4)), d);
+
+    uint64_t space = uint32_t(_mm256_movemask_epi8(ws)) | maskAVX2(v, ' ');
+
+    masks.quote      |= maskAVX2(v, quote) << (32*i);
+    masks.backslash  |= maskAVX2(v, '\\') << (32*i);
+    masks.structural |= structural << (32*i);
+    masks.space      |= space << (32*i);
+  }
+}
+#endif
+
+//---
+
+using ClassifyProc = void (*)(const char *, char, CJsonScan::BlockMasks &);
+
+struct Impl {
+  ClassifyProc proc { classifyScalar };
+  const char*  name { "scalar" };
+
+  Impl() {
+#ifdef CJSON_SCAN_X86
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx2")) {
+      proc = classifyAVX2;
+      name = "avx2";
+    }
+    else {
+      proc = classifySSE2;
+      name = "sse2";
+    }
+#endif
+  }
+};
+
+const Impl &impl() {
+  static Impl s_impl;
+
+  return s_impl;
+}
+
+//---
+
+// scan nested values from p (skipping strings and balancing brackets) to the
+// first unmatched close bracket (nullptr if none) calling sepProc for each
+// top level comma
+template<typename SEP_PROC>
+const char *
+scanNested(const char *p, const char *e, const SEP_PROC &sepProc)
+{
+  CJsonScan::BlockMasks masks;
+
+  bool        inString = false;
+  int         depth    = 0;
+  const char *escaped  = nullptr; // char after backslash in string
+
+  while (p < e) {
+    size_t n = std::min(size_t(e - p), size_t(CJsonScan::BLOCK_SIZE));
+
+    if (n == CJsonScan::BLOCK_SIZE)
+      CJsonScan::classify(p, '\"', masks);
+    else
+      CJsonScan::classifyPartial(p, n, '\"', masks);
+
+    auto mask = masks.quote | masks.backslash | masks.structural;
+
+    while (mask) {
+      const char *p1 = p + firstBit(mask);
+
+      mask &= mask - 1;
+
+      if (p1 == escaped)
+        continue;
+
+      char c = *p1;
+
+      if (inString) {
+        if      (c == '\"')
+          inString = false;
+        else if (c == '\\')
+          escaped = p1 + 1;
+
+        continue;
+      }
+
+      switch (c) {
+        case '\"':
+          inString = true;
+          break;
+        case '[': case '{':
+          ++depth;
+          break;
+        case ']': case '}':
+          if (depth == 0)
+            return p1;
+
+          --depth;
+
+          break;
+        case ',':
+          if (depth == 0)
+            sepProc(p1);
+          break;
+        default:
+          break;
+      }
+    }
+
+    p += n;
+  }
+
+  return nullptr;
+}
+
+}
+
+//------
+
+void
+CJsonScan::
+classify(const char *p, char quote, BlockMasks &masks)
+{
+  impl().proc(p, quote, masks);
+}
+
+void
+CJsonScan::
+classifyPartial(const char *p, size_t n, char quote, BlockMasks &masks)
+{
+  char block[BLOCK_SIZE];
+
+  memcpy(block, p, n);
+  memset(block + n, 0, BLOCK_SIZE - n);
+
+  impl().proc(block, quote, masks);
+
+  // zero padding only matches nothing, but be explicit
+  uint64_t valid = (n > 0 ? (~uint64_t(0) >> (BLOCK_SIZE - n)) : 0);
+
+  masks.quote      &= valid;
+  masks.backslash  &= valid;
+  masks.structural &= valid;
+  masks.space      &= valid;
+}
+
+const char *
+CJsonScan::
+skipSpace(const char *p, const char *e)
+{
+  // most runs are empty or a single char so check directly first
+  if (p >= e || ! isSpaceChar(static_cast<unsigned char>(*p)))
+    return p;
+
+  ++p;
+
+  if (p >= e || ! isSpaceChar(static_cast<unsigned char>(*p)))
+    return p;
+
+  BlockMasks masks;
+
+  while (p + BLOCK_SIZE <= e) {
+    classify(p, '\"', masks);
+
+    if (~masks.space)
+      return p + firstBit(~masks.space);
+
+    p += BLOCK_SIZE;
+  }
+
+  if (p < e) {
+    size_t n = size_t(e - p);
+
+    classifyPartial(p, n, '\"', masks);
+
+    uint64_t valid = ~uint64_t(0) >> (BLOCK_SIZE - n);
+
+    if (~masks.space & valid)
+      return p + firstBit(~masks.space & valid);
+  }
+
+  return e;
+}
+
+const char *
+CJsonScan::
+findQuoteOrEscape(const char *p, const char *e, char quote)
+{
+  BlockMasks masks;
+
+  while (p + BLOCK_SIZE <= e) {
+    classify(p, quote, masks);
+
+    auto mask = masks.quote | masks.backslash;
+
+    if (mask)
+      return p + firstBit(mask);
+
+    p += BLOCK_SIZE;
+  }
+
+  if (p < e) {
+    classifyPartial(p, size_t(e - p), quote, masks);
+
+    auto mask = masks.quote | masks.backslash;
+
+    if (mask)
+      return p + firstBit(mask);
+  }
+
+  return e;
+}
+
+const char *
+CJsonScan::
+splitArray(const char *p, const char *e, std::vector<const char *> &seps)
+{
+  const char *pe = scanNested(p, e, [&](const char *sep) { seps.push_back(sep); });
+
+  if (! pe || *pe != ']')
+    return nullptr;
+
+  seps.push_back(pe);
+
+  return pe;
+}
+
+const char *
+CJsonScan::
+skipContainer(const char *p, const char *e)
+{
+  if (p >= e || (*p != '{' && *p != '['))
+    return nullptr;
+
+  char close = (*p == '{' ? '}' : ']');
+
+  const char *pe = scanNested(p + 1, e, [](const char *) { });
+
+  if (! pe || *pe != close)
+    return nullptr;
+
+  return pe + 1;
+}
+
+const char *
+CJsonScan::
+implName()
+{
+  return impl().name;
+}
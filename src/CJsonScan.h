@@ -0,0 +1,52 @@
+#ifndef CJsonScan_H
+#define CJsonScan_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Vectorized character classification for the JSON parser.
+//
+// Input is classified 64 bytes at a time into bit masks (bit i set for
+// byte i of the block) so the parser can jump straight to the next
+// interesting character instead of testing one byte at a time.
+//
+// SSE2 is used on all x86-64 cpus, AVX2 when the running cpu supports it
+// (selected once at runtime). Other targets use a scalar implementation.
+namespace CJsonScan {
+  struct BlockMasks {
+    uint64_t quote      { 0 }; // quote char (" or ' when allowed)
+    uint64_t backslash  { 0 }; // backslash
+    uint64_t structural { 0 }; // one of {}[]:,
+    uint64_t space      { 0 }; // space, \t, \n, \v, \f, \r (isspace)
+  };
+
+  enum { BLOCK_SIZE = 64 };
+
+  // classify the BLOCK_SIZE bytes at p
+  void classify(const char *p, char quote, BlockMasks &masks);
+
+  // classify the n (< BLOCK_SIZE) bytes at p (remaining bits are clear)
+  void classifyPartial(const char *p, size_t n, char quote, BlockMasks &masks);
+
+  // return first non-space char in [p, e) (e if none)
+  const char *skipSpace(const char *p, const char *e);
+
+  // return first quote or backslash char in [p, e) (e if none)
+  const char *findQuoteOrEscape(const char *p, const char *e, char quote);
+
+  // find the top level separators (',' and the closing ']') of the array whose
+  // contents start at p (after the '['). Strings are skipped and brackets
+  // balanced but values are not validated. Returns the closing bracket or
+  // nullptr if not found (unterminated or unbalanced).
+  const char *splitArray(const char *p, const char *e, std::vector<const char *> &seps);
+
+  // return char after the object or array starting at p (nullptr if not
+  // found). Like splitArray the contents are not validated.
+  const char *skipContainer(const char *p, const char *e);
+
+  // name of selected implementation (avx2, sse2 or scalar)
+  const char *implName();
+}
+
+#endif
@@ -0,0 +1,77 @@
+#ifndef CJsonShapes_H
+#define CJsonShapes_H
+
+#include <CJson.h>
+#include <mutex>
+#include <unordered_map>
+
+// Shared object shapes of a CJson.
+//
+// Loaded objects with the same member names (in the same order) use the same
+// shape. Objects with many members or documents with too many distinct
+// layouts (e.g. objects used as maps with data keys) get unshared shapes.
+class CJson::Shapes {
+ public:
+  Shapes() { }
+
+ ~Shapes() {
+    for (auto &ps : shapes_)
+      ps.second->~Shape();
+  }
+
+  Shapes(const Shapes &) = delete;
+  Shapes &operator=(const Shapes &) = delete;
+
+  // get shape for keys (nullptr if not shared). Thread safe.
+  Shape *shape(const Symbol *keys, size_t n) {
+    if (n > s_maxKeys)
+      return nullptr;
+
+    size_t h = keysHash(keys, n);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    auto pr = shapes_.equal_range(h);
+
+    for (auto p = pr.first; p != pr.second; ++p) {
+      if ((*p).second->isKeys(keys, n))
+        return (*p).second;
+    }
+
+    if (shapes_.size() >= s_maxShapes)
+      return nullptr;
+
+    void *p = arena_.allocate(sizeof(Shape), alignof(Shape));
+
+    auto *shape = new (p) Shape(keys, n, /*shared*/true, &arena_);
+
+    shapes_.emplace(h, shape);
+
+    return shape;
+  }
+
+ private:
+  static size_t keysHash(const Symbol *keys, size_t n) {
+    size_t h = n;
+
+    for (size_t i = 0; i < n; ++i)
+      h = (h ^ reinterpret_cast<uintptr_t>(keys[i].data()))*0x100000001b3ULL;
+
+    return h;
+  }
+
+ private:
+  // maximum keys of shared shape
+  static constexpr size_t s_maxKeys = 256;
+
+  // maximum number of shared shapes
+  static constexpr size_t s_maxShapes = 16*1024;
+
+  using ShapeMap = std::unordered_multimap<size_t, Shape *>;
+
+  std::mutex                          mutex_;
+  std::pmr::monotonic_buffer_resource arena_;
+  ShapeMap                            shapes_;
+};
+
+#endif
@@ -0,0 +1,60 @@
+#include <CJson.h>
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+
+CJson::Symbol
+CJson::Symbols::
+intern(std::string_view name)
+{
+  {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+
+  auto p = names_.find(name);
+
+  if (p != names_.end())
+    return *p;
+  }
+
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+
+  // name may have been added since read lock was released
+  auto p = names_.find(name);
+
+  if (p != names_.end())
+    return *p;
+
+  // chars are never freed (symbol views are stable). Empty name needs an
+  // address too.
+  auto *chars = static_cast<char *>(chars_.allocate(std::max(name.size(), size_t(1)), 1));
+
+  if (! name.empty())
+    memcpy(chars, name.data(), name.size());
+
+  return *names_.emplace(chars, name.size()).first;
+}
+
+bool
+CJson::Symbols::
+find(std::string_view name, Symbol &symbol) const
+{
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+
+  auto p = names_.find(name);
+
+  if (p == names_.end())
+    return false;
+
+  symbol = *p;
+
+  return true;
+}
+
+size_t
+CJson::Symbols::
+size() const
+{
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+
+  return names_.size();
+}
@@ -0,0 +1,238 @@
+#include <CJson.h>
+#include <CJsonNumber.h>
+#include <cstring>
+
+CJson::ValueType
+CJson::Tape::Cursor::
+type() const
+{
+  if (! isValid())
+    return ValueType::VALUE_NONE;
+
+  switch (tag(entry(ind_))) {
+    case TAG_OBJECT_START: return ValueType::VALUE_OBJECT;
+    case TAG_ARRAY_START : return ValueType::VALUE_ARRAY;
+    case TAG_STRING      : return ValueType::VALUE_STRING;
+    case TAG_REAL        :
+    case TAG_INTEGER     :
+    case TAG_UNSIGNED    : return ValueType::VALUE_NUMBER;
+    case TAG_TRUE        : return ValueType::VALUE_TRUE;
+    case TAG_FALSE       : return ValueType::VALUE_FALSE;
+    case TAG_NULL        : return ValueType::VALUE_NULL;
+    default              : return ValueType::VALUE_NONE;
+  }
+}
+
+std::string_view
+CJson::Tape::Cursor::
+str() const
+{
+  if (! isValid())
+    return std::string_view();
+
+  auto t = tag(entry(ind_));
+
+  if (t != TAG_STRING && t != TAG_KEY)
+    return std::string_view();
+
+  const char *p = tape_->strings_.data() + payload(entry(ind_));
+
+  uint32_t len;
+
+  memcpy(&len, p, sizeof(len));
+
+  return std::string_view(p + sizeof(len), len);
+}
+
+double
+CJson::Tape::Cursor::
+number() const
+{
+  // value bits are in next entry (only present for number)
+  if (! isNumber())
+    return 0.0;
+
+  uint64_t bits = entry(ind_ + 1);
+
+  switch (tag(entry(ind_))) {
+    case TAG_REAL: {
+      double r;
+
+      memcpy(&r, &bits, sizeof(r));
+
+      return r;
+    }
+    case TAG_INTEGER : return double(int64_t(bits));
+    default          : return double(bits);
+  }
+}
+
+bool
+CJson::Tape::Cursor::
+isInteger() const
+{
+  if (! isValid())
+    return false;
+
+  auto t = tag(entry(ind_));
+
+  return (t == TAG_INTEGER || t == TAG_UNSIGNED);
+}
+
+bool
+CJson::Tape::Cursor::
+toInt64(int64_t &i) const
+{
+  if (! isNumber())
+    return false;
+
+  uint64_t bits = entry(ind_ + 1);
+
+  switch (tag(entry(ind_))) {
+    case TAG_REAL: {
+      double r;
+
+      memcpy(&r, &bits, sizeof(r));
+
+      return CJsonNumber::isIntegral(r, i);
+    }
+    case TAG_INTEGER: {
+      i = int64_t(bits);
+
+      return true;
+    }
+    default: {
+      if (bits > uint64_t(INT64_MAX))
+        return false;
+
+      i = int64_t(bits);
+
+      return true;
+    }
+  }
+}
+
+//---
+
+uint
+CJson::Tape::Cursor::
+size() const
+{
+  if (! isComposite())
+    return 0;
+
+  uint64_t count = (payload(entry(ind_)) >> COUNT_SHIFT) & COUNT_MASK;
+
+  if (count < COUNT_MASK)
+    return uint(count);
+
+  // saturated count so count values
+  bool isObj = isObject();
+
+  uint n = 0;
+
+  size_t end = next().index() - 1;
+
+  for (size_t i = ind_ + 1; i < end; ++n) {
+    if (isObj)
+      ++i; // key
+
+    i = Cursor(tape_, i).next().index();
+  }
+
+  return n;
+}
+
+bool
+CJson::Tape::Cursor::
+getNamedValue(std::string_view name, Cursor &value) const
+{
+  if (! isObject())
+    return false;
+
+  bool found = false;
+
+  for (const auto &nv : nameValueArray()) {
+    if (nv.first == name) {
+      value = nv.second;
+      found = true;
+    }
+  }
+
+  return found;
+}
+
+CJson::Tape::Cursor
+CJson::Tape::Cursor::
+at(uint i) const
+{
+  if (! isArray())
+    return Cursor();
+
+  uint n = 0;
+
+  for (const auto &value : values()) {
+    if (n++ == i)
+      return value;
+  }
+
+  return Cursor();
+}
+
+//---
+
+CJson::Tape::Cursor
+CJson::Tape::Cursor::
+next() const
+{
+  auto e = entry(ind_);
+
+  switch (tag(e)) {
+    case TAG_OBJECT_START:
+    case TAG_ARRAY_START :
+      return Cursor(tape_, payload(e) & INDEX_MASK);
+    case TAG_REAL    :
+    case TAG_INTEGER :
+    case TAG_UNSIGNED:
+      return Cursor(tape_, ind_ + 2);
+    default:
+      return Cursor(tape_, ind_ + 1);
+  }
+}
+
+bool
+CJson::Tape::Cursor::
+parse(Handler &handler) const
+{
+  if (! isValid())
+    return false;
+
+  size_t end = next().index();
+
+  for (size_t i = ind_; i < end; ++i) {
+    auto e = entry(i);
+
+    bool rc = true;
+
+    switch (tag(e)) {
+      case TAG_OBJECT_START: rc = handler.startObject(); break;
+      case TAG_OBJECT_END  : rc = handler.endObject  (); break;
+      case TAG_ARRAY_START : rc = handler.startArray (); break;
+      case TAG_ARRAY_END   : rc = handler.endArray   (); break;
+      case TAG_KEY         : rc = handler.key   (Cursor(tape_, i).str()); break;
+      case TAG_STRING      : rc = handler.string(Cursor(tape_, i).str()); break;
+      case TAG_REAL        : rc = handler.number(Cursor(tape_, i).number()); ++i; break;
+      case TAG_INTEGER     : rc = handler.integer(int64_t(entry(i + 1))); ++i; break;
+      case TAG_UNSIGNED    : rc = handler.unsignedInteger(entry(i + 1)); ++i; break;
+      case TAG_TRUE        : rc = handler.boolean(true); break;
+      case TAG_FALSE       : rc = handler.boolean(false); break;
+      case TAG_NULL        : rc = handler.null(); break;
+      default              : break;
+    }
+
+    if (! rc)
+      return false;
+  }
+
+  return true;
+}
@@ -0,0 +1,156 @@
+#ifndef CJsonTapeBuilder_H
+#define CJsonTapeBuilder_H
+
+#include <CJson.h>
+#include <cstring>
+
+// handler to build tape from parse events
+class CJson::TapeBuilder final : public CJson::Handler {
+ public:
+  // tape is cleared and space reserved for typical json of input size
+  // (avoids copies as the tape grows, unused pages are not touched)
+  TapeBuilder(Tape &tape, size_t inputSize) : tape_(tape) {
+    tape_.clear();
+
+    tape_.entries_.reserve(inputSize/4 + 2);
+    tape_.strings_.reserve(inputSize/2);
+  }
+
+  bool startObject() override { return startContainer(Tape::TAG_OBJECT_START); }
+
+  bool key(std::string_view name) override {
+    return addString(Tape::TAG_KEY, name);
+  }
+
+  bool endObject() override { return endContainer(Tape::TAG_OBJECT_END); }
+
+  bool startArray() override { return startContainer(Tape::TAG_ARRAY_START); }
+
+  bool endArray() override { return endContainer(Tape::TAG_ARRAY_END); }
+
+  bool string(std::string_view str) override {
+    countValue();
+
+    return addString(Tape::TAG_STRING, str);
+  }
+
+  bool number(double r) override {
+    uint64_t bits;
+
+    memcpy(&bits, &r, sizeof(bits));
+
+    return addNumber(Tape::TAG_REAL, bits);
+  }
+
+  bool integer(int64_t i) override { return addNumber(Tape::TAG_INTEGER, uint64_t(i)); }
+
+  bool unsignedInteger(uint64_t u) override { return addNumber(Tape::TAG_UNSIGNED, u); }
+
+  bool boolean(bool b) override {
+    countValue();
+
+    addEntry(b ? Tape::TAG_TRUE : Tape::TAG_FALSE, 0);
+
+    return true;
+  }
+
+  bool null() override {
+    countValue();
+
+    addEntry(Tape::TAG_NULL, 0);
+
+    return true;
+  }
+
+  // error if build stopped because tape limits were exceeded (null if none)
+  const char *error() const { return error_; }
+
+ private:
+  // open object or array (start entry index and number of values)
+  struct Frame {
+    size_t   start { 0 };
+    uint64_t count { 0 };
+  };
+
+  using Stack = std::vector<Frame>;
+
+  void addEntry(Tape::Tag tag, uint64_t payload) {
+    tape_.entries_.push_back(Tape::makeEntry(tag, payload));
+  }
+
+  void countValue() {
+    if (! stack_.empty())
+      ++stack_.back().count;
+  }
+
+  bool addString(Tape::Tag tag, std::string_view str) {
+    // string lengths are 32 bit
+    if (str.size() > UINT32_MAX) {
+      error_ = "String too large for tape";
+      return false;
+    }
+
+    auto &strings = tape_.strings_;
+
+    addEntry(tag, strings.size());
+
+    auto len = uint32_t(str.size());
+
+    strings.append(reinterpret_cast<const char *>(&len), sizeof(len));
+    strings.append(str.data(), str.size());
+
+    return true;
+  }
+
+  bool addNumber(Tape::Tag tag, uint64_t bits) {
+    countValue();
+
+    addEntry(tag, 0);
+
+    tape_.entries_.push_back(bits);
+
+    return true;
+  }
+
+  bool startContainer(Tape::Tag tag) {
+    countValue();
+
+    stack_.push_back(Frame{tape_.entries_.size(), 0});
+
+    // payload set at end
+    addEntry(tag, 0);
+
+    return true;
+  }
+
+  bool endContainer(Tape::Tag tag) {
+    auto frame = stack_.back();
+
+    stack_.pop_back();
+
+    // container indices are 32 bit (fail larger tapes)
+    size_t end = tape_.entries_.size() + 1;
+
+    if (end > Tape::INDEX_MASK) {
+      error_ = "Document too large for tape";
+      return false;
+    }
+
+    addEntry(tag, frame.start);
+
+    uint64_t count = std::min(frame.count, Tape::COUNT_MASK);
+
+    auto &entry = tape_.entries_[frame.start];
+
+    entry |= (count << Tape::COUNT_SHIFT) | end;
+
+    return true;
+  }
+
+ private:
+  Tape&       tape_;
+  Stack       stack_;
+  const char* error_ { nullptr };
+};
+
+#endif
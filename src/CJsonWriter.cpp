@@ -0,0 +1,84 @@
+#include <CJson.h>
+#include <CJsonNumber.h>
+#include <charconv>
+#include <cerrno>
+#include <unistd.h>
+
+void
+CJson::Writer::
+writeInteger(int64_t i)
+{
+  char buffer[24];
+
+  auto res = std::to_chars(buffer, buffer + sizeof(buffer), i);
+
+  write(std::string_view(buffer, size_t(res.ptr - buffer)));
+}
+
+void
+CJson::Writer::
+writeUnsigned(uint64_t u)
+{
+  char buffer[24];
+
+  auto res = std::to_chars(buffer, buffer + sizeof(buffer), u);
+
+  write(std::string_view(buffer, size_t(res.ptr - buffer)));
+}
+
+void
+CJson::Writer::
+writeReal(double r)
+{
+  // format in place at end of buffer
+  size_t len = buffer_.size();
+
+  buffer_.resize(len + CJsonNumber::MAX_FORMAT_LEN);
+
+  char *end = CJsonNumber::format(&buffer_[len], r);
+
+  buffer_.resize(size_t(end - buffer_.data()));
+
+  checkFlush();
+}
+
+bool
+CJson::Writer::
+flush()
+{
+  if (buffer_.empty())
+    return true;
+
+  bool rc = true;
+
+  if      (os_) {
+    os_->write(buffer_.data(), std::streamsize(buffer_.size()));
+
+    rc = bool(*os_);
+  }
+  else if (fd_ >= 0) {
+    const char *p = buffer_.data();
+    size_t      n = buffer_.size();
+
+    while (n > 0) {
+      auto len = ::write(fd_, p, n);
+
+      if (len < 0) {
+        if (errno == EINTR)
+          continue;
+
+        rc = false;
+        break;
+      }
+
+      p += len;
+      n -= size_t(len);
+    }
+  }
+  else
+    return true; // string output
+
+  buffer_.clear();
+
+  return rc;
+}
@@ -0,0 +1,443 @@
+// Number conversion validation.
+//
+// Checks that numbers converted by the parser (CJsonNumber::parseDouble, the
+// document loader and the push parser) are bit identical to the C library
+// strtod for rounding edge cases: halfway cases, integers near 2^53,
+// subnormals, long (19+ digit) mantissas and large exponents.
+//
+// Exits with a non-zero status if any number differs.
+
+#include <CJson.h>
+#include <CJsonNumber.h>
+#include <cfloat>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace {
+
+using Texts = std::vector<std::string>;
+
+//---
+
+// number handler which records the last number (integers as double)
+class NumberHandler : public CJson::Handler {
+ public:
+  bool number(double r) override { value = r; ++count; return true; }
+
+  bool integer(int64_t i) override { return number(double(i)); }
+
+  bool unsignedInteger(uint64_t u) override { return number(double(u)); }
+
+  double value { 0.0 };
+  int    count { 0 };
+};
+
+//---
+
+bool sameBits(double r1, double r2) {
+  return memcmp(&r1, &r2, sizeof(r1)) == 0;
+}
+
+std::string bitsStr(double r) {
+  char buffer[64];
+
+  snprintf(buffer, sizeof(buffer), "%.17g", r);
+
+  return buffer;
+}
+
+//---
+
+// exact decimal text of positive integer n*2^e (used for halfway points)
+//  . digits are stored least significant first in base 10^9
+class BigDecimal {
+ public:
+  BigDecimal(uint64_t n) {
+    while (n) {
+      digits_.push_back(uint32_t(n % BASE));
+
+      n /= BASE;
+    }
+  }
+
+  void mul(uint32_t m) {
+    uint64_t carry = 0;
+
+    for (auto &d : digits_) {
+      uint64_t v = uint64_t(d)*m + carry;
+
+      d     = uint32_t(v % BASE);
+      carry = v / BASE;
+    }
+
+    while (carry) {
+      digits_.push_back(uint32_t(carry % BASE));
+
+      carry /= BASE;
+    }
+  }
+
+  // decimal text of value/10^scale
+  std::string str(int scale) const {
+    std::string s;
+
+    for (size_t i = digits_.size(); i > 0; --i) {
+      char buffer[16];
+
+      if (i == digits_.size())
+        snprintf(buffer, sizeof(buffer), "%u", digits_[i - 1]);
+      else
+        snprintf(buffer, sizeof(buffer), "%09u", digits_[i - 1]);
+
+      s += buffer;
+    }
+
+    if (s.empty())
+      s = "0";
+
+    if (scale <= 0)
+      return s;
+
+    if (int(s.size()) <= scale)
+      s = std::string(size_t(scale - int(s.size()) + 1), '0') + s;
+
+    s.insert(s.size() - size_t(scale), ".");
+
+    return s;
+  }
+
+ private:
+  static constexpr uint64_t BASE = 1000000000;
+
+  std::vector<uint32_t> digits_;
+};
+
+// exact decimal text of point halfway between positive finite r and next
+// larger double
+std::string halfwayText(double r) {
+  int e;
+
+  double f = frexp(r, &e); // r = f*2^e, 0.5 <= f < 1
+
+  // r = m*2^(e - 53) with 53 bit m (subnormals have fewer bits)
+  int shift = e - 53;
+
+  if (shift < -1074)
+    shift = -1074;
+
+  auto m = uint64_t(ldexp(f, e - shift));
+
+  // halfway = (2m + 1)*2^(shift - 1)
+  BigDecimal big(2*m + 1);
+
+  int p = shift - 1;
+
+  if (p >= 0) {
+    for (int i = 0; i < p; ++i)
+      big.mul(2);
+
+    return big.str(0);
+  }
+
+  // n/2^k = n*5^k/10^k
+  for (int i = 0; i < -p; ++i)
+    big.mul(5);
+
+  return big.str(-p);
+}
+
+//---
+
+// halfway texts for double and the texts just below and above it
+void addHalfway(Texts &texts, double r) {
+  auto s = halfwayText(r);
+
+  texts.push_back(s);
+
+  // just above (exact halfway has finite digits)
+  texts.push_back(s + (s.find('.') == std::string::npos ? ".000000000000000000001" :
+                                                          "000000000000000000001"));
+
+  // just below (decrement last digit and append nines)
+  auto s1 = s;
+
+  size_t i = s1.size();
+
+  while (i > 0) {
+    --i;
+
+    if (s1[i] == '.')
+      continue;
+
+    if (s1[i] > '0') {
+      --s1[i];
+      break;
+    }
+
+    s1[i] = '9';
+  }
+
+  // no leading zero (e.g. 100 -> 099)
+  if (s1.size() > 1 && s1[0] == '0' && s1[1] != '.')
+    s1.erase(0, 1);
+
+  texts.push_back(s1 + (s1.find('.') == std::string::npos ? ".999999999" : "999999999"));
+}
+
+void addHalfwayCases(Texts &texts, std::mt19937_64 &rand) {
+  // well known halfway values
+  addHalfway(texts, 1.0);
+  addHalfway(texts, 2.0);
+  addHalfway(texts, 0.1);
+  addHalfway(texts, 1e23);
+  addHalfway(texts, 9007199254740992.0);
+  addHalfway(texts, DBL_MIN);
+  addHalfway(texts, DBL_MAX/2);
+  addHalfway(texts, nextafter(DBL_MAX, 0.0));
+
+  // random doubles of all magnitudes
+  for (int i = 0; i < 2000; ++i) {
+    uint64_t bits = rand() & 0x7fefffffffffffffULL;
+
+    double r;
+
+    memcpy(&r, &bits, sizeof(r));
+
+    if (r > 0.0 && std::isfinite(r))
+      addHalfway(texts, r);
+  }
+}
+
+void addIntegerCases(Texts &texts) {
+  const int64_t p53 = int64_t(1) << 53;
+
+  for (int64_t i = p53 - 4; i <= p53 + 12; ++i) {
+    auto s = std::to_string(i);
+
+    texts.push_back(s);
+    texts.push_back("-" + s);
+    texts.push_back(s + ".0");
+    texts.push_back(s + "e0");
+    texts.push_back(s + "0e-1");
+  }
+
+  // int64/uint64 limits and beyond
+  texts.push_back("9223372036854775807");
+  texts.push_back("9223372036854775808");
+  texts.push_back("-9223372036854775808");
+  texts.push_back("-9223372036854775809");
+  texts.push_back("18446744073709551615");
+  texts.push_back("18446744073709551616");
+  texts.push_back("18446744073709551617");
+  texts.push_back("36893488147419103232");
+}
+
+void addSubnormalCases(Texts &texts, std::mt19937_64 &rand) {
+  texts.push_back("4.9406564584124654e-324");
+  texts.push_back("2.4703282292062327e-324");
+  texts.push_back("2.4703282292062328e-324");
+  texts.push_back("2.4703282292062327208828439643411068618252990130716238221279284125033775364e-324");
+  texts.push_back("1e-320");
+  texts.push_back("2.2250738585072011e-308");
+  texts.push_back("2.2250738585072012e-308");
+  texts.push_back("2.2250738585072014e-308");
+  texts.push_back("2.225073858507201136057409796709131975934819546351645648e-308");
+  texts.push_back("1e-400");
+  texts.push_back("-1e-400");
+
+  addHalfway(texts, 0.0 + DBL_TRUE_MIN);
+  addHalfway(texts, 2*DBL_TRUE_MIN);
+  addHalfway(texts, nextafter(DBL_MIN, 0.0));
+
+  for (int i = 0; i < 1000; ++i) {
+    uint64_t bits = rand() & 0x000fffffffffffffULL;
+
+    double r;
+
+    memcpy(&r, &bits, sizeof(r));
+
+    char buffer[64];
+
+    snprintf(buffer, sizeof(buffer), "%.17g", r);
+    texts.push_back(buffer);
+
+    snprintf(buffer, sizeof(buffer), "%.25e", r);
+    texts.push_back(buffer);
+
+    if (r > 0.0)
+      addHalfway(texts, r);
+  }
+}
+
+void addLongMantissaCases(Texts &texts, std::mt19937_64 &rand) {
+  texts.push_back("1234567890123456789");
+  texts.push_back("12345678901234567890");
+  texts.push_back("1234567890123456789012345678901234567890");
+  texts.push_back("0.1234567890123456789012345678901234567890");
+  texts.push_back("9999999999999999999.999999999999999999");
+  texts.push_back("0.30000000000000000000000000000000000001");
+  texts.push_back("1.00000000000000000000000000000000000001");
+  texts.push_back("0.000000000000000000000000000000000000000000001234567890123456789");
+
+  for (int i = 0; i < 5000; ++i) {
+    int n = 19 + int(rand() % 20);
+
+    std::string s;
+
+    for (int j = 0; j < n; ++j)
+      s += char('0' + (j == 0 ? 1 + rand() % 9 : rand() % 10));
+
+    // decimal point and exponent
+    int dot = int(rand() % size_t(n + 1));
+
+    if (dot < n)
+      s.insert(size_t(dot), dot == 0 ? "0." : ".");
+
+    if (rand() % 2)
+      s += "e" + std::to_string(int(rand() % 600) - 300);
+
+    texts.push_back(s);
+  }
+}
+
+void addExponentCases(Texts &texts, std::mt19937_64 &rand) {
+  texts.push_back("1e308");
+  texts.push_back("1.7976931348623157e308");
+  texts.push_back("1.7976931348623158e308");
+  texts.push_back("1.7976931348623159e308");
+  texts.push_back("-1.7976931348623159e308");
+  texts.push_back("1e309");
+  texts.push_back("-1e309");
+  texts.push_back("1e99999");
+  texts.push_back("1e-99999");
+  texts.push_back("0e99999");
+  texts.push_back("0.000001e313");
+  texts.push_back("100000000000000000000000e-330");
+  texts.push_back("1e22");
+  texts.push_back("1e23");
+  texts.push_back("9007199254740993e-22");
+  texts.push_back("9007199254740993e22");
+  texts.push_back("123456789e-100000");
+  texts.push_back("123456789e100000");
+  texts.push_back("1E+2");
+  texts.push_back("1e-0");
+
+  for (int i = 0; i < 2000; ++i) {
+    auto m = rand() % 10000000000000000ULL;
+
+    int e = int(rand() % 700) - 350;
+
+    texts.push_back(std::to_string(m) + "e" + std::to_string(e));
+  }
+}
+
+//---
+
+class Checker {
+ public:
+  Checker() { json_.setQuiet(true); }
+
+  int numFailed() const { return numFailed_; }
+  int numChecked() const { return numChecked_; }
+
+  void check(const std::string &text) {
+    ++numChecked_;
+
+    double expected = strtod(text.c_str(), nullptr);
+
+    // number module
+    double r1 = CJsonNumber::parseDouble(text.c_str(), text.size());
+
+    checkValue(text, "parseDouble", r1, expected);
+
+    // document loader (numeric array and object member)
+    CJson::ValueP value;
+
+    if (! json_.loadString("[" + text + "]", value))
+      fail(text, "loadString", "parse failed");
+    else {
+      auto *array = value->cast<CJson::Array>();
+
+      checkValue(text, "loadString", array->at(0)->toNumber(), expected);
+    }
+
+    if (! json_.loadString("{\"n\":" + text + "}", value))
+      fail(text, "loadString", "parse failed");
+    else {
+      auto *obj = value->cast<CJson::Object>();
+
+      checkValue(text, "loadString", obj->getNamedValue("n")->toNumber(), expected);
+    }
+
+    // push parser (number split over chunks)
+    NumberHandler handler;
+
+    CJson::PushParser parser(&json_, handler);
+
+    std::string data = "[" + text + "]";
+
+    size_t half = data.size()/2;
+
+    if (! parser.feed(data.c_str(), half) ||
+        ! parser.feed(data.c_str() + half, data.size() - half) ||
+        ! parser.finish() || handler.count != 1)
+      fail(text, "PushParser", "parse failed");
+    else
+      checkValue(text, "PushParser", handler.value, expected);
+  }
+
+ private:
+  void checkValue(const std::string &text, const char *id, double r, double expected) {
+    if (sameBits(r, expected))
+      return;
+
+    fail(text, id, bitsStr(r) + " (expected " + bitsStr(expected) + ")");
+  }
+
+  void fail(const std::string &text, const char *id, const std::string &msg) {
+    if (numFailed_ < 20)
+      std::cerr << "FAIL " << id << ": " << text << " -> " << msg << "\n";
+
+    ++numFailed_;
+  }
+
+ private:
+  CJson json_;
+  int   numFailed_  { 0 };
+  int   numChecked_ { 0 };
+};
+
+}
+
+int
+main(int, char **)
+{
+  std::mt19937_64 rand(12345);
+
+  Texts texts;
+
+  addHalfwayCases     (texts, rand);
+  addIntegerCases     (texts);
+  addSubnormalCases   (texts, rand);
+  addLongMantissaCases(texts, rand);
+  addExponentCases    (texts, rand);
+
+  Checker checker;
+
+  for (const auto &text : texts) {
+    checker.check(text);
+
+    // negative
+    if (text[0] != '-')
+      checker.check("-" + text);
+  }
+
+  std::cout << checker.numChecked() << " numbers checked, " <<
+               checker.numFailed() << " failed\n";
+
+  return (checker.numFailed() ? 1 : 0);
+}
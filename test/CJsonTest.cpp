@@ -9,9 +9,12 @@ main(int argc, char **argv)
   std::string match;
 
   bool typeFlag  = false;
+  bool linesFlag = false;
   bool hierFlag  = false;
   bool nameFlag  = false;
   bool valueFlag = false;
+  bool allocFlag = false;
+  bool tapeFlag  = false;
 
   std::string hierName  = "children";
   std::string hierKey   = "name";
@@ -33,6 +36,31 @@ main(int argc, char **argv)
       else if (arg == "match"   ) match = argv[++i];
       else if (arg == "type"    ) typeFlag = true;
       else if (arg == "short"   ) json->setPrintShort(true);
+      else if (arg == "lines"   ) linesFlag = true;
+      else if (arg == "parallel") json->setParallelLoad(true);
+      else if (arg == "lazy"    ) json->setLazyLoad(true);
+      else if (arg == "zero_copy") json->setZeroCopy(true);
+      else if (arg == "raw_numbers") json->setRawNumbers(true);
+      else if (arg == "alloc_stats") allocFlag = true;
+      else if (arg == "tape"    ) tapeFlag = true;
+      else if (arg == "threads" ) {
+        ++i;
+
+        if (i < argc)
+          json->setNumThreads(atoi(argv[i]));
+      }
+      else if (arg == "max_depth") {
+        ++i;
+
+        if (i < argc)
+          json->setMaxDepth(atoi(argv[i]));
+      }
+      else if (arg == "max_size") {
+        ++i;
+
+        if (i < argc)
+          json->setMaxSize(size_t(atoll(argv[i])));
+      }
       else if (arg == "hierName") {
         ++i;
 
@@ -53,7 +81,7 @@ main(int argc, char **argv)
       }
       else if (arg == "h" || arg == "help") {
         std::cerr << "CJsonTest [-debug] [-quiet] [-flat] [-csv] [-match <pattern>] "
-                     "[-type] [-short] [-hier] [-name] [-value] "
+                     "[-type] [-short] [-lines] [-parallel] [-lazy] [-zero_copy] [-raw_numbers] [-alloc_stats] [-tape] [-threads <n>] [-max_depth <n>] [-max_size <n>] [-hier] [-name] [-value] "
                      "[-hierName <name>] [-hierKey <key>] [hierValue <value>] "
                      "<filename>\n";
         exit(0);
@@ -70,52 +98,104 @@ main(int argc, char **argv)
   if (filename == "")
     exit(1);
 
-  CJson::ValueP value;
-
-  if (! json->loadFile(filename.c_str(), value)) {
-    std::cerr << "Parse failed\n";
-    exit(1);
-  }
-
-  if (json->isDebug())
-    std::cout << *value << "\n";
-
-  if      (match != "") {
-    CJson::Values values;
-
-    if (! json->matchValues(value, match, values))
-      exit(1);
-
+  auto printValues = [&](const CJson::Values &values) {
     if (typeFlag) {
       for (const auto &v : values) {
         std::cout << v->hierTypeName() << "\n";
       }
     }
     else {
+      // buffered output of all values
+      CJson::Writer writer(std::cout);
+
       if (json->isStringToReal()) {
         for (const auto &v : values) {
-          v->printReal(std::cout);
+          v->printReal(writer);
 
-          std::cout << "\n";
+          writer.put('\n');
         }
       }
       else {
         for (const auto &v : values) {
-          if      (typeFlag)
-            std::cout << v->hierTypeName();
-          else if (json->isPrintShort())
-            v->printShort(std::cout);
+          if      (json->isPrintShort())
+            v->printShort(writer);
           else if (nameFlag)
-            v->printName(std::cout);
+            v->printName(writer);
           else if (valueFlag)
-            v->printValue(std::cout);
+            v->printValue(writer);
           else
-            v->print(std::cout);
+            v->print(writer);
 
-          std::cout << "\n";
+          writer.put('\n');
         }
       }
     }
+  };
+
+  // newline delimited records (match applied to each record)
+  if (linesFlag) {
+    auto rc = json->processLinesFile(filename,
+      [&](size_t /*line*/, const CJson::ValueP &value) {
+        CJson::Values values;
+
+        // skip record with no match (only parse errors stop processing)
+        if (match != "") {
+          if (! json->matchValues(value, match, values))
+            return true;
+        }
+        else
+          values.push_back(value);
+
+        printValues(values);
+
+        return true;
+      });
+
+    if (! rc) {
+      std::cerr << "Parse failed\n";
+      exit(1);
+    }
+
+    exit(0);
+  }
+
+  CJson::ValueP value;
+  CJson::Tape   tape;
+
+  // load into tape (match uses tape, other output uses value tree of root)
+  if (tapeFlag) {
+    if (! json->loadTapeFile(filename, tape)) {
+      std::cerr << "Parse failed\n";
+      exit(1);
+    }
+
+    if (json->isDebug() || match == "")
+      value = json->tapeValue(tape.root());
+  }
+  else if (! json->loadFile(filename.c_str(), value)) {
+    std::cerr << "Parse failed\n";
+    exit(1);
+  }
+
+  if (allocFlag) {
+    auto stats = json->allocStats();
+
+    std::cerr << "Allocations: " << stats.count << " (" << stats.bytes << " bytes)\n";
+  }
+
+  if (json->isDebug())
+    std::cout << *value << "\n";
+
+  if      (match != "") {
+    CJson::Values values;
+
+    bool rc = (tapeFlag ? json->matchValues(tape.root(), match, values) :
+                          json->matchValues(value, match, values));
+
+    if (! rc)
+      exit(1);
+
+    printValues(values);
   }
   else if (typeFlag) {
     std::cout << value->hierTypeName() << "\n";
@@ -157,7 +237,7 @@ main(int argc, char **argv)
                 if (pobj->getNamedValue(hierKey, keyValue) && keyValue->isString()) {
                   const auto *keyStr = keyValue->cast<CJson::String>();
 
-                  package = keyStr->value() + "/" + package;
+                  package = std::string(keyStr->value()) + "/" + package;
                 }
 
                 parent = parent->parent();
@@ -187,7 +267,7 @@ main(int argc, char **argv)
         if      (valueValue->isNumber()) {
           const auto *valueNum = valueValue->cast<CJson::Number>();
 
-          NameValue nv(keyStr->value(), std::to_string(valueNum->value()));
+          NameValue nv(keyStr->value(), valueNum->to_string());
 
           packageNameValues[package].push_back(nv);
         }
@@ -0,0 +1,274 @@
+// Value and tape access checks.
+//
+// Checks access edge cases of loaded values and tape cursors which are not
+// covered by the CJsonTest regression output.
+//
+// Exits with a non-zero status if any check fails.
+
+#include <CJson.h>
+#include <algorithm>
+#include <iostream>
+
+namespace {
+
+int numFailed = 0;
+
+void check(bool b, const char *desc) {
+  if (b)
+    return;
+
+  std::cerr << "FAIL " << desc << "\n";
+
+  ++numFailed;
+}
+
+//---
+
+// views of scalar, empty and last tape entries are empty
+void checkTapeViews() {
+  CJson json;
+
+  CJson::Tape tape;
+
+  check(json.loadTapeString("[1,\"a\",true,{},[],{\"b\":null}]", tape), "tape load");
+
+  auto root = tape.root();
+
+  check(root.size() == 6, "tape array size");
+
+  int n = 0;
+
+  for (const auto &value : root.values()) {
+    auto values = value.values();
+    auto nvs    = value.nameValueArray();
+
+    int nv = 0;
+
+    for (const auto &v : values) { (void) v; ++nv; }
+
+    for (const auto &v : nvs) { (void) v; ++nv; }
+
+    if      (value.isObject())
+      check(values.empty() && nv == int(value.size()), "tape object views");
+    else if (value.isArray())
+      check(nvs.empty() && nv == int(value.size()), "tape array views");
+    else
+      check(values.empty() && nvs.empty() && nv == 0, "tape scalar views");
+
+    ++n;
+  }
+
+  check(n == 6, "tape array values");
+
+  // single scalar document (view end would be before begin)
+  check(json.loadTapeString("42", tape), "tape scalar load");
+
+  int nv = 0;
+
+  for (const auto &v : tape.root().values()) { (void) v; ++nv; }
+
+  for (const auto &v : tape.root().nameValueArray()) { (void) v; ++nv; }
+
+  check(nv == 0, "tape scalar root views");
+}
+
+//---
+
+// number handler which counts integer and real events
+class NumberHandler : public CJson::Handler {
+ public:
+  bool number(double) override { ++numReal; return true; }
+
+  bool integer(int64_t) override { ++numInteger; return true; }
+
+  bool unsignedInteger(uint64_t) override { ++numInteger; return true; }
+
+  int numInteger { 0 };
+  int numReal    { 0 };
+};
+
+// only plain digit numbers are integers (fraction or exponent makes a real)
+void checkIntegers() {
+  CJson json;
+
+  json.setQuiet(true);
+
+  const char *integers[] = { "15", "-15", "0", "9223372036854775807", "18446744073709551615" };
+  const char *reals[]    = { "1.5e1", "1e0", "1.0", "-0.0", "1234567890123456789.0", "1E+2", "0e0" };
+
+  auto checkNumber = [&](const std::string &text, bool isInteger) {
+    NumberHandler handler;
+
+    check(json.parseString(text, handler) &&
+          handler.numInteger == (isInteger ? 1 : 0), "parse integer");
+
+    NumberHandler handler1;
+
+    CJson::PushParser parser(&json, handler1);
+
+    check(parser.feed(text.c_str(), text.size()) && parser.finish() &&
+          handler1.numInteger == (isInteger ? 1 : 0), "push parse integer");
+
+    // object member (numeric array elements are stored as reals)
+    CJson::ValueP value;
+
+    check(json.loadString("{\"n\":" + text + "}", value) &&
+          value->cast<CJson::Object>()->getNamedValue("n")->
+            cast<CJson::Number>()->isInteger() == isInteger, "load integer");
+  };
+
+  for (const auto *text : integers)
+    checkNumber(text, true);
+
+  for (const auto *text : reals)
+    checkNumber(text, false);
+}
+
+}
+
+//---
+
+// large (indexed) shapes find all keys after load and after keys are added
+void checkShapes() {
+  CJson json;
+
+  // more keys than a shared shape can have
+  std::string text = "{";
+
+  for (int i = 0; i < 300; ++i)
+    text += (i > 0 ? "," : "") + std::string("\"k") + std::to_string(i) + "\":" + std::to_string(i);
+
+  text += "}";
+
+  CJson::ValueP value;
+
+  check(json.loadString(text, value), "load shape");
+
+  auto *obj = value->cast<CJson::Object>();
+
+  for (int i = 0; i < 300; ++i)
+    check(obj->hasName("k" + std::to_string(i)), "shape key");
+
+  check(! obj->hasName("k300"), "shape missing key");
+
+  // grow indexed shape (table is rebuilt as it fills)
+  auto member = obj->getNamedValue("k0");
+
+  for (int i = 300; i < 1000; ++i)
+    obj->setNamedValue("k" + std::to_string(i), member);
+
+  for (int i = 0; i < 1000; ++i)
+    check(obj->hasName("k" + std::to_string(i)), "grown shape key");
+
+  // small object changed after load grows past linear search
+  check(json.loadString("{\"a\":1}", value), "load small shape");
+
+  obj    = value->cast<CJson::Object>();
+  member = obj->getNamedValue("a");
+
+  for (int i = 0; i < 40; ++i)
+    obj->setNamedValue("k" + std::to_string(i), member);
+
+  for (int i = 0; i < 40; ++i)
+    check(obj->hasName("k" + std::to_string(i)) && obj->hasName("a"), "changed shape key");
+}
+
+//---
+
+// matches on lazy loaded documents (names are interned when objects are
+// expanded) give same values as fully loaded documents
+void checkLazyMatch() {
+  const char *text =
+    "{\"a\":{\"b\":1},\"name\":\"r\",\"children\":[{\"name\":\"c\",\"size\":3}]}";
+
+  const char *matches[] = { "a/b", "a", "name...children...size", "a/{b}" };
+
+  for (const auto *match : matches) {
+    std::string results[2];
+
+    for (int lazy = 0; lazy < 2; ++lazy) {
+      CJson json;
+
+      json.setQuiet(true);
+      json.setLazyLoad(lazy);
+
+      CJson::ValueP value;
+
+      check(json.loadString(text, value), "load lazy match");
+
+      CJson::Values values;
+
+      check(json.matchValues(value, match, values) && ! values.empty(), "lazy match");
+
+      for (const auto &v : values)
+        results[lazy] += v->to_string() + "\n";
+    }
+
+    check(results[0] == results[1], "lazy match values");
+  }
+}
+
+//---
+
+// loads release values of previous load and processed records are released
+// after their batch
+void checkRelease() {
+  CJson json;
+
+  CJson::ValueP value;
+
+  check(json.loadString("{\"a\":[1,2,3],\"b\":\"x\"}", value), "load release");
+
+  auto bytes = json.allocStats().bytes;
+
+  for (int i = 0; i < 100; ++i)
+    check(json.loadString("{\"a\":[1,2,3],\"b\":\"x\"}", value), "load release");
+
+  check(json.allocStats().bytes == bytes, "load release bytes");
+
+  //---
+
+  std::string lines;
+
+  for (int i = 0; i < 50000; ++i)
+    lines += "{\"a\":[1,2,3],\"b\":\"x" + std::to_string(i) + "\"}\n";
+
+  // kept records
+  CJson::Values values;
+
+  check(json.loadLinesData(lines.c_str(), lines.size(), values) &&
+        values.size() == 50000, "load lines");
+
+  auto keptBytes = json.allocStats().bytes;
+
+  // processed records (and match results)
+  size_t maxBytes = 0, n = 0;
+
+  check(json.processLinesData(lines.c_str(), lines.size(),
+    [&](size_t, const CJson::ValueP &value) {
+      CJson::Values values1;
+
+      if (json.matchValues(value, "a", values1) && values1.size() == 1)
+        ++n;
+
+      maxBytes = std::max(maxBytes, json.allocStats().bytes);
+
+      return true;
+    }) && n == 50000, "process lines");
+
+  check(maxBytes < keptBytes/2, "process lines bytes");
+}
+
+int
+main(int, char **)
+{
+  checkTapeViews();
+  checkIntegers();
+  checkShapes();
+  checkLazyMatch();
+  checkRelease();
+
+  std::cout << (numFailed ? "FAILED" : "OK") << "\n";
+
+  return (numFailed ? 1 : 0);
+}